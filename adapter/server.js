@@ -283,6 +283,13 @@ async function main() {
               latestLocationData[location].packetsLost = parsedMqttData.packetsLost;
             if (parsedMqttData.packetsReceived !== undefined)
               latestLocationData[location].packetsReceived = parsedMqttData.packetsReceived;
+
+            // Budget radio (temps d'antenne / duty cycle sur l'heure, surdité RX de la passerelle),
+            // santé des capteurs à trames MEASURE (batterie, mot d'état)
+            for (const key of ["airtimeMs", "batteryMv", "dutyCycle", "nodeStatus", "rxBlindMaxMs", "rxBlindMs", "txAirtimeMs", "txDutyCycle", "txRefused"]) {
+              if (parsedMqttData[key] !== undefined)
+                latestLocationData[location][key] = parsedMqttData[key];
+            }
             
             // Ajout de la séquence et du HMAC pour la traçabilité en DB
             if (parsedMqttData.seq !== undefined)
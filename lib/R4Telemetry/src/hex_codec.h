@@ -0,0 +1,20 @@
+#ifndef HEX_CODEC_H
+#define HEX_CODEC_H
+
+// Table-driven hex codec working on caller buffers (no String, no heap).
+// Shared by the AT payloads (TX/RX/ACK) and the MQTT signatures.
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Writes 2*len lowercase hex chars to out (no terminator). Returns chars written.
+size_t hex_encode(const uint8_t *data, size_t len, char *out);
+
+// Same, plus a NUL terminator: out must hold 2*len + 1 chars.
+size_t hex_encode_cstr(const uint8_t *data, size_t len, char *out);
+
+// Decodes hexLen chars (either case) into out. Returns the number of bytes
+// written, or -1 on odd length, non-hex character or outCap too small.
+int hex_decode(const char *hex, size_t hexLen, uint8_t *out, size_t outCap);
+
+#endif
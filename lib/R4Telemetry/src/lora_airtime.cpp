@@ -0,0 +1,43 @@
+#include "lora_airtime.h"
+
+uint32_t lora_time_on_air_us(uint8_t sf, size_t len) {
+    const uint32_t symbolUs = ((uint32_t)1 << sf) * 1000 / LORA_BW_KHZ;
+    // Low data rate optimisation: mandatory at SF11/SF12 in 125 kHz
+    const int de = (sf >= 11 && LORA_BW_KHZ == 125) ? 1 : 0;
+
+    // Payload symbols: 8 + max(ceil((8PL - 4SF + 28 + 16CRC - 20IH) / 4(SF - 2DE)) * (CR + 4), 0)
+    int32_t bits = 8 * (int32_t)len - 4 * sf + 28 + 16;
+    int32_t perBlock = 4 * (sf - 2 * de);
+    int32_t blocks = bits > 0 ? (bits + perBlock - 1) / perBlock : 0;
+    uint32_t payloadSymbols = 8 + blocks * (LORA_CODING_RATE + 4);
+
+    // Preamble + 4.25 sync symbols, in quarter symbols
+    uint32_t quarterSymbols = (LORA_TX_PREAMBLE + payloadSymbols) * 4 + 17;
+    return quarterSymbols * symbolUs / 4;
+}
+
+// Starts a new bucket when the current one is an hour old (both if it is two)
+static void roll(AirtimeWindow *w, uint32_t nowMs) {
+    uint32_t elapsed = nowMs - w->bucketStartMs;
+    if (elapsed < LORA_DUTY_CYCLE_WINDOW_MS) return;
+    if (elapsed < 2 * LORA_DUTY_CYCLE_WINDOW_MS) {
+        w->previousUs = w->currentUs;
+        w->bucketStartMs += LORA_DUTY_CYCLE_WINDOW_MS;
+    } else {
+        w->previousUs = 0;
+        w->bucketStartMs = nowMs;
+    }
+    w->currentUs = 0;
+}
+
+void airtime_window_add(AirtimeWindow *w, uint32_t nowMs, uint32_t airtimeUs) {
+    roll(w, nowMs);
+    w->currentUs += airtimeUs;
+}
+
+uint32_t airtime_window_us(const AirtimeWindow *w, uint32_t nowMs) {
+    AirtimeWindow rolled = *w;
+    roll(&rolled, nowMs);
+    uint32_t remainingMs = LORA_DUTY_CYCLE_WINDOW_MS - (nowMs - rolled.bucketStartMs);
+    return rolled.currentUs + (uint32_t)((uint64_t)rolled.previousUs * remainingMs / LORA_DUTY_CYCLE_WINDOW_MS);
+}
@@ -0,0 +1,46 @@
+#ifndef LORA_AIRTIME_H
+#define LORA_AIRTIME_H
+
+// Time on air of a LoRa packet (Semtech SX1276 datasheet, section 4.1.1.7)
+// and a sliding one-hour airtime window for the EU868 duty-cycle limit.
+// The radio settings are the ones LoRaModem::configure() programs: BW125,
+// CR 4/5, 12-symbol TX preamble, explicit header, CRC on.
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define LORA_BW_KHZ 125
+#define LORA_CODING_RATE 1      // 4/(4 + CR): 1 = 4/5
+#define LORA_TX_PREAMBLE 12     // symbols
+#define LORA_RX_PREAMBLE 15
+
+// 868.0-868.6 MHz (sub-band g1): 1 % duty cycle, i.e. 36 s of airtime per hour
+#define LORA_DUTY_CYCLE_WINDOW_MS 3600000UL
+#define LORA_DUTY_CYCLE_BUDGET_US 36000000UL
+
+// Microseconds on air for a payload of len bytes at the given SF
+uint32_t lora_time_on_air_us(uint8_t sf, size_t len);
+
+// Airtime of the last hour, estimated from two consecutive one-hour buckets:
+// the previous bucket counts in proportion to its part still inside the
+// window, as if its airtime was spread evenly. Zero-initialise before use.
+struct AirtimeWindow {
+    uint32_t bucketStartMs;  // nowMs at the start of the current bucket
+    uint32_t currentUs;
+    uint32_t previousUs;
+};
+
+void airtime_window_add(AirtimeWindow *w, uint32_t nowMs, uint32_t airtimeUs);
+uint32_t airtime_window_us(const AirtimeWindow *w, uint32_t nowMs);
+
+// True if airtimeUs more stays within LORA_DUTY_CYCLE_BUDGET_US over the last hour
+inline bool airtime_window_allows(const AirtimeWindow *w, uint32_t nowMs, uint32_t airtimeUs) {
+    return airtime_window_us(w, nowMs) + airtimeUs <= LORA_DUTY_CYCLE_BUDGET_US;
+}
+
+// Duty cycle of the last hour in hundredths of a percent (100 = 1 %)
+inline uint16_t airtime_duty_cycle_cp(uint32_t hourAirtimeUs) {
+    return (uint16_t)(hourAirtimeUs / (LORA_DUTY_CYCLE_WINDOW_MS / 10));
+}
+
+#endif
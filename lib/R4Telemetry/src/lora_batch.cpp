@@ -0,0 +1,98 @@
+#include "lora_batch.h"
+
+static inline uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+static inline int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+// LEB128: 7 bits per byte, low group first. Returns the bytes written, 0 if
+// it does not fit.
+static size_t putVarint(uint32_t v, uint8_t *out, size_t cap) {
+    size_t n = 0;
+    do {
+        if (n == cap) return 0;
+        uint8_t b = v & 0x7F;
+        v >>= 7;
+        out[n++] = v ? (b | 0x80) : b;
+    } while (v);
+    return n;
+}
+
+static bool getVarint(const uint8_t **p, const uint8_t *end, uint32_t *v) {
+    uint32_t result = 0;
+    for (uint8_t shift = 0; shift < 35; shift += 7) {
+        if (*p == end) return false;
+        uint8_t b = *(*p)++;
+        result |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *v = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void putLe(uint32_t v, uint8_t *out, size_t n) {
+    for (size_t i = 0; i < n; i++) out[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint32_t getLe(const uint8_t *in, size_t n) {
+    uint32_t v = 0;
+    for (size_t i = 0; i < n; i++) v |= (uint32_t)in[i] << (8 * i);
+    return v;
+}
+
+size_t lora_batch_encode(const LoraReading *readings, size_t count, uint8_t *out, size_t cap, size_t *encoded) {
+    *encoded = 0;
+    if (count == 0 || cap < LORA_BATCH_HEADER_LEN) return 0;
+    if (count > LORA_BATCH_MAX_READINGS) count = LORA_BATCH_MAX_READINGS;
+
+    putLe(readings[0].time, out + 1, 4);
+    putLe((uint16_t)readings[0].temperature, out + 5, 2);
+    putLe((uint16_t)readings[0].humidity, out + 7, 2);
+    size_t len = LORA_BATCH_HEADER_LEN;
+    size_t n = 1;
+
+    for (; n < count; n++) {
+        const LoraReading &prev = readings[n - 1];
+        const LoraReading &cur = readings[n];
+        if (cur.time < prev.time) break;
+
+        uint8_t tmp[15];
+        size_t a = putVarint(cur.time - prev.time, tmp, sizeof(tmp));
+        a += putVarint(zigzag((int32_t)cur.temperature - prev.temperature), tmp + a, sizeof(tmp) - a);
+        a += putVarint(zigzag((int32_t)cur.humidity - prev.humidity), tmp + a, sizeof(tmp) - a);
+        if (len + a > cap) break;
+        for (size_t i = 0; i < a; i++) out[len + i] = tmp[i];
+        len += a;
+    }
+
+    out[0] = (uint8_t)n;
+    *encoded = n;
+    return len;
+}
+
+int lora_batch_decode(const uint8_t *data, size_t len, LoraReading *out, size_t outCap) {
+    if (len < LORA_BATCH_HEADER_LEN) return -1;
+    size_t count = data[0];
+    if (count == 0 || count > outCap) return -1;
+
+    out[0].time = getLe(data + 1, 4);
+    out[0].temperature = (int16_t)getLe(data + 5, 2);
+    out[0].humidity = (int16_t)getLe(data + 7, 2);
+
+    const uint8_t *p = data + LORA_BATCH_HEADER_LEN;
+    const uint8_t *end = data + len;
+    for (size_t i = 1; i < count; i++) {
+        uint32_t dt, dT, dH;
+        if (!getVarint(&p, end, &dt) || !getVarint(&p, end, &dT) || !getVarint(&p, end, &dH)) return -1;
+
+        int32_t t = out[i - 1].temperature + unzigzag(dT);
+        int32_t h = out[i - 1].humidity + unzigzag(dH);
+        if (t < INT16_MIN || t > INT16_MAX || h < INT16_MIN || h > INT16_MAX) return -1;
+        if (out[i - 1].time + dt < out[i - 1].time) return -1;
+
+        out[i].time = out[i - 1].time + dt;
+        out[i].temperature = (int16_t)t;
+        out[i].humidity = (int16_t)h;
+    }
+    return (p == end) ? (int)count : -1;
+}
@@ -0,0 +1,34 @@
+#ifndef LORA_BATCH_H
+#define LORA_BATCH_H
+
+// Codec of the readings carried by a BATCH frame (after its [SEQ, ADR] prefix):
+//   [COUNT, TIME0(4, LE), T0(2, LE), H0(2, LE)]
+//   then for each following reading: varint(dt) varint(zz(dT)) varint(zz(dH))
+// dt = seconds since the previous reading, dT/dH = change of the centi-unit
+// values (0x7FFF = sensor error, like DATA frames), zig-zag mapped so small
+// negative changes also fit in one byte. A 15 s cadence with slowly moving
+// values costs 3 bytes per reading instead of a whole frame.
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define LORA_BATCH_MAX_READINGS 16
+#define LORA_BATCH_HEADER_LEN 9
+
+struct LoraReading {
+    uint32_t time;        // Unix time of the capture
+    int16_t temperature;  // 1/100 °C
+    int16_t humidity;     // 1/100 %
+};
+
+// Encodes readings[0..count) in time order, as many as fit in cap bytes.
+// Returns the bytes written (0 if not even the first one fits) and the
+// number of readings encoded in *encoded.
+size_t lora_batch_encode(const LoraReading *readings, size_t count, uint8_t *out, size_t cap, size_t *encoded);
+
+// Decodes a batch into out (at most outCap readings). Returns the number of
+// readings, or -1 if the data is truncated, has trailing bytes, overflows
+// 16 bits or goes back in time.
+int lora_batch_decode(const uint8_t *data, size_t len, LoraReading *out, size_t outCap);
+
+#endif
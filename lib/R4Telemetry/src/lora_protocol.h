@@ -0,0 +1,306 @@
+#ifndef LORA_PROTOCOL_H
+#define LORA_PROTOCOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "security_utils.h"
+
+// --- Frame formats ---
+// Legacy (version 0): [ID, TYPE, body...] + HMAC(32)
+// Version 1         : [HDR, ID, TYPE, body...] + TAG(4/8/16/32), HMAC-SHA256
+// Version 2         : same layout as v1, SipHash-2-4 tag (4 or 8 bytes)
+//   HDR = (version << 4) | flags (bits 2-3) | tag code (bits 0-1)
+//   A legacy frame starts with the sensor ID (< 16), so its high nibble is 0.
+// The TAG is the MAC of everything before it (engine chosen by the version),
+// truncated to the length announced by HDR. Replies (ACK, time response) use the tag length of the
+// request and sign their own bytes followed by the request tag, which binds
+// them to that exact request.
+
+#define LORA_PROTO_LEGACY 0
+#define LORA_PROTO_V1 1
+#define LORA_PROTO_V2 2
+
+// HDR flags (v1/v2 DATA/BATCH). A sender that sets neither gets the 1/2-byte
+// ACK of earlier firmware.
+#define LORA_HDR_NO_ACK 0x04   // The sender is not listening: do not reply
+#define LORA_HDR_CUM_ACK 0x08  // The sender understands the cumulative ACK
+
+#define LORA_FULL_TAG_LEN 32
+#define LORA_MAX_FRAME_LEN 64
+
+enum LoraMsgType : uint8_t {
+    LORA_MSG_DATA = 2,       // body: [SEQ, T_low, T_high, H_low, H_high] (+ [ADR] in v1/v2)
+    LORA_MSG_TIME_REQ = 3,   // body: 4 bytes (padding in legacy, nonce in v1/v2)
+    LORA_MSG_TIME_RESP = 4,  // body: [TIME(4, LE)]
+    LORA_MSG_ACK = 5,        // v1/v2, body: [SEQ] (+ [ADR]) or [CUM, MAP(2, LE), ADR, TIME(4, LE), MS(2, LE)]. Legacy ACK = raw 32-byte HMAC
+    LORA_MSG_BATCH = 6,      // v1/v2, body: [SEQ, ADR, readings (lora_batch.h)], ACKed like DATA
+    LORA_MSG_BEACON = 7,     // v1/v2, gateway broadcast, see below
+    LORA_MSG_PARITY = 8,     // v1/v2, body: [FIRST, K, XOR of the K readings (4)], never ACKed
+    LORA_MSG_MEASURE = 9     // v1/v2, body: [SEQ, ADR, records (lora_tlv.h)], ACKed like DATA
+};
+
+static const uint8_t LORA_DATA_BODY_LEN = 5;
+static const uint8_t LORA_DATA_ADR_BODY_LEN = 6;
+static const uint8_t LORA_TIME_BODY_LEN = 4;
+static const uint8_t LORA_ACK_BODY_LEN = 1;
+static const uint8_t LORA_ACK_ADR_BODY_LEN = 2;
+static const uint8_t LORA_ACK_CUM_BODY_LEN = 4;
+static const uint8_t LORA_ACK_TIME_BODY_LEN = 10;
+static const uint8_t LORA_BATCH_PREFIX_LEN = 2;
+static const uint8_t LORA_PARITY_BODY_LEN = 6;
+static const uint8_t LORA_MEASURE_PREFIX_LEN = 2;
+
+// Reading of a sensor in error in DATA/BATCH frames (MEASURE leaves the channel out)
+#define LORA_SENSOR_ERROR 0x7FFF
+
+// --- Body layouts ---
+// A field is a little-endian integer at a fixed offset of a frame body; get()
+// and put() work in place on the caller's buffer. Each layout is checked
+// against the body lengths above at compile time, so both sketches and the
+// host tools share one definition of every frame.
+template <size_t Offset, typename T>
+struct LoraField {
+    static_assert(sizeof(T) <= 4, "LoraField holds up to 32 bits");
+    static constexpr size_t offset = Offset;
+    static constexpr size_t end = Offset + sizeof(T);
+
+    static inline T get(const uint8_t *body) {
+        uint32_t v = 0;
+        for (size_t i = 0; i < sizeof(T); i++) v |= (uint32_t)body[Offset + i] << (8 * i);
+        return (T)v;
+    }
+    static inline void put(uint8_t *body, T value) {
+        uint32_t v = (uint32_t)value;
+        for (size_t i = 0; i < sizeof(T); i++) body[Offset + i] = (uint8_t)(v >> (8 * i));
+    }
+};
+
+struct LoraDataBody {
+    typedef LoraField<0, uint8_t> Seq;
+    typedef LoraField<1, int16_t> Temperature;  // 1/100 °C
+    typedef LoraField<3, int16_t> Humidity;     // 1/100 %
+    typedef LoraField<5, uint8_t> Adr;          // v1/v2
+};
+static_assert(LoraDataBody::Humidity::end == LORA_DATA_BODY_LEN, "DATA body layout");
+static_assert(LoraDataBody::Adr::end == LORA_DATA_ADR_BODY_LEN, "DATA body layout (ADR)");
+
+// TIME_RESP (the request carries a nonce of the same size)
+struct LoraTimeBody {
+    typedef LoraField<0, uint32_t> Time;
+};
+static_assert(LoraTimeBody::Time::end == LORA_TIME_BODY_LEN, "TIME_RESP body layout");
+
+struct LoraAckBody {
+    typedef LoraField<0, uint8_t> Seq;
+    typedef LoraField<1, uint8_t> Adr;
+};
+static_assert(LoraAckBody::Adr::end == LORA_ACK_ADR_BODY_LEN, "ACK body layout");
+
+struct LoraCumAckBody {
+    typedef LoraField<0, uint8_t> Cum;
+    typedef LoraField<1, uint16_t> Map;
+    typedef LoraField<3, uint8_t> Adr;
+    typedef LoraField<4, uint32_t> Time;
+    typedef LoraField<8, uint16_t> Ms;
+};
+static_assert(LoraCumAckBody::Adr::end == LORA_ACK_CUM_BODY_LEN, "cumulative ACK body layout");
+static_assert(LoraCumAckBody::Ms::end == LORA_ACK_TIME_BODY_LEN, "cumulative ACK body layout (clock)");
+
+// BATCH and MEASURE: this prefix, then their own records
+struct LoraPrefixBody {
+    typedef LoraField<0, uint8_t> Seq;
+    typedef LoraField<1, uint8_t> Adr;
+};
+static_assert(LoraPrefixBody::Adr::end == LORA_BATCH_PREFIX_LEN, "BATCH prefix layout");
+static_assert(LoraPrefixBody::Adr::end == LORA_MEASURE_PREFIX_LEN, "MEASURE prefix layout");
+
+// Cumulative ACK: every sequence up to CUM (mod 256) was received, CUM + 1 was
+// not; bit i of MAP is set if CUM + 2 + i was. A reply to the frame that asked
+// for it, so it also confirms that frame. It ends with the gateway clock when
+// the ACK was built (Unix TIME + MS), which replaces the TIME_REQ exchange;
+// the node accepts the 4-byte form without it as well.
+#define LORA_ACK_MAP_BITS 16
+
+// True if `seq` is covered by a cumulative ACK (up to 128 sequences behind CUM)
+inline bool loraAckCovers(uint8_t cum, uint16_t map, uint8_t seq) {
+    uint8_t d = (uint8_t)(seq - cum);
+    if (d == 0 || d >= 128) return true;
+    if (d < 2 || d >= 2 + LORA_ACK_MAP_BITS) return false;
+    return (map >> (d - 2)) & 1;
+}
+
+// --- Forward error correction ---
+// After every K DATA or MEASURE frames (sequences FIRST .. FIRST + K - 1) the
+// node sends a PARITY frame: the XOR of their readings [T_low, T_high, H_low,
+// H_high], 0x7FFF for a channel a MEASURE frame left out. A gateway that got
+// all of them but one rebuilds the missing reading without a retransmission.
+// The ADR byte is not covered (a retransmission may carry different settings).
+#define LORA_FEC_PAYLOAD_LEN 4
+#define LORA_FEC_MAX_GROUP 8
+
+struct LoraFecReading {
+    typedef LoraField<0, int16_t> Temperature;
+    typedef LoraField<2, int16_t> Humidity;
+};
+static_assert(LoraFecReading::Humidity::end == LORA_FEC_PAYLOAD_LEN, "FEC reading layout");
+
+struct LoraParityBody {
+    typedef LoraField<0, uint8_t> First;
+    typedef LoraField<1, uint8_t> Count;
+    static constexpr size_t payload = Count::end;  // XOR of the readings
+};
+static_assert(LoraParityBody::payload + LORA_FEC_PAYLOAD_LEN == LORA_PARITY_BODY_LEN, "PARITY body layout");
+
+// --- Adaptive data rate ---
+// ADR byte = (SF << 4) | power step. In a DATA frame: the radio settings the
+// node used for it; in the ACK: the settings the gateway wants for the next
+// frames. Power step 0 is LORA_MAX_TX_POWER, each step is 3 dB less.
+// 0 = no ADR information.
+#define LORA_ADR_NONE 0x00
+#define LORA_MIN_SF 7
+#define LORA_MAX_SF 12
+#define LORA_DEFAULT_SF 7
+#define LORA_MAX_TX_POWER 14     // dBm (EU868, 25 mW ERP)
+#define LORA_POWER_STEPS 5       // 14, 11, 8, 5, 2 dBm
+
+inline uint8_t loraAdrMake(uint8_t sf, uint8_t powerStep) { return (uint8_t)((sf << 4) | (powerStep & 0x0F)); }
+inline uint8_t loraAdrSf(uint8_t adr) { return adr >> 4; }
+inline uint8_t loraAdrPowerStep(uint8_t adr) { return adr & 0x0F; }
+inline int8_t loraAdrPowerDbm(uint8_t adr) { return (int8_t)(LORA_MAX_TX_POWER - 3 * loraAdrPowerStep(adr)); }
+
+// False for LORA_ADR_NONE and out-of-range fields
+inline bool loraAdrValid(uint8_t adr) {
+    return loraAdrSf(adr) >= LORA_MIN_SF && loraAdrSf(adr) <= LORA_MAX_SF && loraAdrPowerStep(adr) < LORA_POWER_STEPS;
+}
+
+static const uint8_t LORA_ADR_DEFAULT = (LORA_DEFAULT_SF << 4);
+
+// --- TDMA beacon ---
+// Broadcast by the gateway at the start of every superframe, from
+// LORA_GATEWAY_ID, signed with the network key (no request to bind to):
+//   [HDR, 0, BEACON, TIME(4, LE), PERIOD(2, LE, s), SLOT(1, x10 ms), COUNT,
+//    IDS(COUNT), ACK(ceil(COUNT / 8))] + TAG
+// Slot i starts i * SLOT after the beacon and belongs to IDS[i]; the
+// LORA_BEACON_JOIN_SLOTS slots after the last one are shared by nodes that are
+// not scheduled yet. ACK bit i is set if IDS[i] was heard during the previous
+// superframe. The next beacon is due PERIOD seconds after TIME.
+#define LORA_GATEWAY_ID 0
+#define LORA_BEACON_MAX_SLOTS 32
+#define LORA_BEACON_JOIN_SLOTS 2
+#define LORA_BEACON_SLOT_UNIT_MS 10
+
+static const uint8_t LORA_BEACON_FIXED_LEN = 8;
+
+struct LoraBeaconBody {
+    typedef LoraField<0, uint32_t> Time;
+    typedef LoraField<4, uint16_t> Period;
+    typedef LoraField<6, uint8_t> Slot;
+    typedef LoraField<7, uint8_t> Count;
+    static constexpr size_t ids = Count::end;
+};
+static_assert(LoraBeaconBody::ids == LORA_BEACON_FIXED_LEN, "BEACON body layout");
+
+struct LoraBeacon {
+    uint32_t time;
+    uint16_t periodSec;
+    uint16_t slotMs;
+    uint8_t count;
+    const uint8_t *ids;     // points into the frame
+    const uint8_t *ackMap;
+};
+
+constexpr size_t loraBeaconBodyLen(uint8_t count) { return LORA_BEACON_FIXED_LEN + count + (count + 7) / 8; }
+
+// False if the body length does not match COUNT or a field is out of range
+inline bool loraParseBeacon(const uint8_t *body, size_t len, LoraBeacon *beacon) {
+    if (len < LORA_BEACON_FIXED_LEN) return false;
+    uint8_t count = LoraBeaconBody::Count::get(body);
+    if (count > LORA_BEACON_MAX_SLOTS || len != loraBeaconBodyLen(count)) return false;
+    beacon->time = LoraBeaconBody::Time::get(body);
+    beacon->periodSec = LoraBeaconBody::Period::get(body);
+    beacon->slotMs = LoraBeaconBody::Slot::get(body) * LORA_BEACON_SLOT_UNIT_MS;
+    beacon->count = count;
+    beacon->ids = body + LoraBeaconBody::ids;
+    beacon->ackMap = beacon->ids + count;
+    return beacon->periodSec != 0 && beacon->slotMs != 0;
+}
+
+// Slot scheduled for nodeId, -1 if it has none (join window)
+inline int loraBeaconSlot(const LoraBeacon &beacon, uint8_t nodeId) {
+    for (uint8_t i = 0; i < beacon.count; i++) {
+        if (beacon.ids[i] == nodeId) return i;
+    }
+    return -1;
+}
+
+inline bool loraBeaconAcked(const LoraBeacon &beacon, uint8_t slot) {
+    return slot < beacon.count && (beacon.ackMap[slot >> 3] >> (slot & 7)) & 1;
+}
+
+static const uint8_t loraTagLengths[4] = { 32, 4, 8, 16 };
+
+// Tag code for a tag length, 0xFF if the length is not supported
+inline uint8_t loraTagCode(uint8_t tagLen) {
+    for (uint8_t i = 0; i < 4; i++) {
+        if (loraTagLengths[i] == tagLen) return i;
+    }
+    return 0xFF;
+}
+
+inline uint8_t loraMakeHeader(uint8_t version, uint8_t tagLen, uint8_t flags = 0) {
+    return (uint8_t)((version << 4) | (flags & 0x0C) | (loraTagCode(tagLen) & 0x03));
+}
+
+inline MacAlgorithm loraMacForVersion(uint8_t version) {
+    return (version == LORA_PROTO_V2) ? MAC_SIPHASH_2_4 : MAC_HMAC_SHA256;
+}
+
+inline uint8_t loraHeaderVersion(uint8_t hdr) { return hdr >> 4; }
+inline uint8_t loraHeaderTagLen(uint8_t hdr) { return loraTagLengths[hdr & 0x03]; }
+
+// Decoded view over a received frame (points into the caller's buffer)
+struct LoraFrameView {
+    uint8_t version;
+    uint8_t nodeId;
+    uint8_t type;
+    uint8_t flags;     // LORA_HDR_* (0 for legacy frames)
+    const uint8_t *body;
+    size_t bodyLen;
+    const uint8_t *tag;
+    size_t tagLen;
+    size_t signedLen;  // bytes covered by the tag (frame start .. tag)
+};
+
+// Splits a raw frame into header/body/tag. Returns false on unknown version, a
+// tag longer than the engine's output, or a frame too short for its tag.
+inline bool loraParseFrame(const uint8_t *frame, size_t len, LoraFrameView *view) {
+    size_t headerLen;
+    if (len == 0) return false;
+    view->version = loraHeaderVersion(frame[0]);
+
+    if (view->version == LORA_PROTO_LEGACY) {
+        headerLen = 2;
+        view->tagLen = LORA_FULL_TAG_LEN;
+        view->nodeId = frame[0];
+        view->flags = 0;
+    } else if (view->version == LORA_PROTO_V1 || view->version == LORA_PROTO_V2) {
+        headerLen = 3;
+        view->tagLen = loraHeaderTagLen(frame[0]);
+        view->nodeId = frame[1];
+        view->flags = frame[0] & 0x0C;
+    } else {
+        return false;
+    }
+
+    if (view->tagLen > mac_output_len(loraMacForVersion(view->version))) return false;
+    if (len < headerLen + view->tagLen) return false;
+
+    view->type = frame[headerLen - 1];
+    view->signedLen = len - view->tagLen;
+    view->body = frame + headerLen;
+    view->bodyLen = view->signedLen - headerLen;
+    view->tag = frame + view->signedLen;
+    return true;
+}
+
+#endif
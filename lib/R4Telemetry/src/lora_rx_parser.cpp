@@ -0,0 +1,74 @@
+#include "lora_rx_parser.h"
+#include "hex_codec.h"
+#include <string.h>
+
+static const char URC_PREFIX[] = "+TEST: ";
+static const char RX_TAG[] = "RX \"";
+static const char LEN_TAG[] = "LEN:";
+static const char RSSI_TAG[] = ", RSSI:";
+static const char SNR_TAG[] = ", SNR:";
+
+// Consumes a literal at *p, false if it does not match
+static bool expectLiteral(const char **p, const char *end, const char *lit, size_t litLen) {
+    if ((size_t)(end - *p) < litLen || memcmp(*p, lit, litLen) != 0) return false;
+    *p += litLen;
+    return true;
+}
+
+// Consumes an optionally signed decimal (max 5 digits: RSSI/SNR/LEN all fit)
+static bool parseInt(const char **p, const char *end, int *out) {
+    const char *s = *p;
+    bool negative = false;
+    if (s < end && (*s == '-' || *s == '+')) {
+        negative = (*s == '-');
+        s++;
+    }
+
+    const char *digits = s;
+    int value = 0;
+    while (s < end && *s >= '0' && *s <= '9') {
+        if (s - digits == 5) return false;
+        value = value * 10 + (*s - '0');
+        s++;
+    }
+    if (s == digits) return false;
+
+    *out = negative ? -value : value;
+    *p = s;
+    return true;
+}
+
+LoraRxLineType lora_parse_rx_line(const char *line, size_t len, LoraRxMeta *meta,
+                                  uint8_t *frame, size_t frameCap, size_t *frameLen) {
+    const char *p = line;
+    const char *end = line + len;
+
+    if (!expectLiteral(&p, end, URC_PREFIX, sizeof(URC_PREFIX) - 1)) return RX_LINE_OTHER;
+
+    // +TEST: RX "<hex>"  -- the closing quote must be the last character
+    if (expectLiteral(&p, end, RX_TAG, sizeof(RX_TAG) - 1)) {
+        if (p == end || end[-1] != '"') return RX_LINE_MALFORMED;
+        size_t hexLen = end - 1 - p;
+        if (hexLen == 0) return RX_LINE_MALFORMED;
+
+        int decoded = hex_decode(p, hexLen, frame, frameCap);
+        if (decoded < 0) return RX_LINE_MALFORMED;
+        *frameLen = decoded;
+        return RX_LINE_FRAME;
+    }
+
+    // +TEST: LEN:<n>, RSSI:<r>, SNR:<s>
+    if (expectLiteral(&p, end, LEN_TAG, sizeof(LEN_TAG) - 1)) {
+        LoraRxMeta m;
+        if (!parseInt(&p, end, &m.len) ||
+            !expectLiteral(&p, end, RSSI_TAG, sizeof(RSSI_TAG) - 1) || !parseInt(&p, end, &m.rssi) ||
+            !expectLiteral(&p, end, SNR_TAG, sizeof(SNR_TAG) - 1) || !parseInt(&p, end, &m.snr) ||
+            p != end) {
+            return RX_LINE_MALFORMED;
+        }
+        *meta = m;
+        return RX_LINE_META;
+    }
+
+    return RX_LINE_OTHER;
+}
@@ -0,0 +1,34 @@
+#ifndef LORA_RX_PARSER_H
+#define LORA_RX_PARSER_H
+
+// Single-pass parser for the Wio-E5 test-mode receive URCs, working in place
+// on the modem's line buffer (no String, no heap, no copy of the hex text):
+//   +TEST: LEN:7, RSSI:-42, SNR:11
+//   +TEST: RX "0102..."
+// Every line is scanned at most once, so a malformed or oversized line costs
+// O(length). A rejected line leaves *meta and *frameLen untouched, but bad hex
+// is only found while decoding: frame may be clobbered on RX_LINE_MALFORMED.
+
+#include <stdint.h>
+#include <stddef.h>
+
+enum LoraRxLineType : uint8_t {
+    RX_LINE_OTHER = 0,   // not a receive URC (command response, echo...)
+    RX_LINE_META,        // "+TEST: LEN:..., RSSI:..., SNR:..."
+    RX_LINE_FRAME,       // "+TEST: RX \"<hex>\"", decoded into the frame buffer
+    RX_LINE_MALFORMED    // receive URC with bad fields, bad hex or too long
+};
+
+struct LoraRxMeta {
+    int len;
+    int rssi;
+    int snr;
+};
+
+// Classifies one line (without CR/LF). META fills *meta, FRAME writes the
+// decoded bytes to frame (at most frameCap) and their count to *frameLen.
+// frame is scratch space until RX_LINE_FRAME is returned.
+LoraRxLineType lora_parse_rx_line(const char *line, size_t len, LoraRxMeta *meta,
+                                  uint8_t *frame, size_t frameCap, size_t *frameLen);
+
+#endif
@@ -0,0 +1,63 @@
+#include "lora_tlv.h"
+#include <string.h>
+
+void lora_tlv_init(LoraTlvWriter *w, uint8_t *out, size_t cap) {
+    w->out = out;
+    w->cap = cap;
+    w->len = 0;
+    w->overflow = false;
+}
+
+bool lora_tlv_put(LoraTlvWriter *w, uint8_t type, const uint8_t *value, uint8_t len) {
+    if (w->cap - w->len < (size_t)LORA_TLV_HEADER_LEN + len) {
+        w->overflow = true;
+        return false;
+    }
+    w->out[w->len++] = type;
+    w->out[w->len++] = len;
+    memcpy(w->out + w->len, value, len);
+    w->len += len;
+    return true;
+}
+
+bool lora_tlv_put_u16(LoraTlvWriter *w, uint8_t type, uint16_t value) {
+    uint8_t le[2] = { (uint8_t)(value & 0xFF), (uint8_t)(value >> 8) };
+    return lora_tlv_put(w, type, le, sizeof(le));
+}
+
+bool lora_tlv_put_u32(LoraTlvWriter *w, uint8_t type, uint32_t value) {
+    uint8_t le[4] = { (uint8_t)(value & 0xFF), (uint8_t)((value >> 8) & 0xFF),
+                      (uint8_t)((value >> 16) & 0xFF), (uint8_t)(value >> 24) };
+    return lora_tlv_put(w, type, le, sizeof(le));
+}
+
+bool lora_tlv_next(const uint8_t *data, size_t len, size_t *offset, LoraTlvRecord *record) {
+    size_t at = *offset;
+    if (at >= len || len - at < LORA_TLV_HEADER_LEN) return false;
+    uint8_t valueLen = data[at + 1];
+    if (len - at - LORA_TLV_HEADER_LEN < valueLen) return false;
+
+    record->type = data[at];
+    record->len = valueLen;
+    record->value = data + at + LORA_TLV_HEADER_LEN;
+    *offset = at + LORA_TLV_HEADER_LEN + valueLen;
+    return true;
+}
+
+bool lora_tlv_valid(const uint8_t *data, size_t len) {
+    size_t offset = 0;
+    LoraTlvRecord record;
+    while (lora_tlv_next(data, len, &offset, &record)) {}
+    return offset == len;
+}
+
+uint16_t lora_tlv_u16(const LoraTlvRecord &record) {
+    if (record.len != 2) return 0;
+    return record.value[0] | (record.value[1] << 8);
+}
+
+uint32_t lora_tlv_u32(const LoraTlvRecord &record) {
+    if (record.len != 4) return 0;
+    return record.value[0] | (record.value[1] << 8) | ((uint32_t)record.value[2] << 16) |
+           ((uint32_t)record.value[3] << 24);
+}
@@ -0,0 +1,62 @@
+#ifndef LORA_TLV_H
+#define LORA_TLV_H
+
+// Codec of the measurement records carried by a MEASURE frame (after its
+// [SEQ, ADR] prefix): a sequence of
+//   [TYPE, LEN, VALUE(LEN, LE)]
+// in any order, each type at most once. A decoder skips the types it does not
+// know, so a node can add a channel without a new frame layout; a channel
+// with nothing to report (sensor error) is left out instead of being sent as
+// a magic value. The layout of the frame itself is set by the version nibble
+// of its header, like the other frames.
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define LORA_TLV_HEADER_LEN 2
+
+enum LoraTlvType : uint8_t {
+    LORA_TLV_TEMPERATURE = 0x01,  // int16, 1/100 °C
+    LORA_TLV_HUMIDITY = 0x02,     // int16, 1/100 %
+    LORA_TLV_BATTERY = 0x03,      // uint16, mV
+    LORA_TLV_STATUS = 0x04,       // uint16, LORA_STATUS_* bits
+    LORA_TLV_TIME = 0x05          // uint32, Unix time of the capture
+};
+
+// LORA_TLV_STATUS bits
+#define LORA_STATUS_SENSOR_OK 0x0001   // Last read of the temperature/humidity sensor succeeded
+#define LORA_STATUS_TIME_SYNCED 0x0002 // Clock set from the gateway since boot
+#define LORA_STATUS_TDMA 0x0004        // Sent in a slot of the gateway beacon
+
+struct LoraTlvWriter {
+    uint8_t *out;
+    size_t cap;
+    size_t len;
+    bool overflow;      // A record did not fit (and was not written)
+};
+
+struct LoraTlvRecord {
+    uint8_t type;
+    uint8_t len;
+    const uint8_t *value;  // points into the frame
+};
+
+void lora_tlv_init(LoraTlvWriter *w, uint8_t *out, size_t cap);
+
+// Appends a record; false (and w->overflow) if it does not fit
+bool lora_tlv_put(LoraTlvWriter *w, uint8_t type, const uint8_t *value, uint8_t len);
+bool lora_tlv_put_u16(LoraTlvWriter *w, uint8_t type, uint16_t value);
+bool lora_tlv_put_u32(LoraTlvWriter *w, uint8_t type, uint32_t value);
+
+// Walks the records of data[0..len): call with *offset = 0, true while one
+// was read. Stops with *offset < len on a truncated record.
+bool lora_tlv_next(const uint8_t *data, size_t len, size_t *offset, LoraTlvRecord *record);
+
+// True if data[0..len) is a whole number of records
+bool lora_tlv_valid(const uint8_t *data, size_t len);
+
+// Value of a record read as an integer, 0 if its length does not match
+uint16_t lora_tlv_u16(const LoraTlvRecord &record);
+uint32_t lora_tlv_u32(const LoraTlvRecord &record);
+
+#endif
@@ -0,0 +1,125 @@
+#include "security_utils.h"
+#include <string.h>
+
+// Resume a context from a stored midstate (one 64-byte block already hashed)
+static void sha256_resume(SHA256_CTX *ctx, const uint32_t state[8]) {
+    ctx->datalen = 0; ctx->bitlen = 512;
+    memcpy(ctx->state, state, sizeof(ctx->state));
+}
+
+void hmac_sha256_key_init(HmacKey *hkey, const uint8_t *key, size_t key_len) {
+    uint8_t k_ipad[64], k_opad[64], tk[32];
+    if (key_len > 64) {
+        SHA256_CTX ctx; sha256_init(&ctx); sha256_update(&ctx, key, key_len); sha256_final(&ctx, tk);
+        key = tk; key_len = 32;
+    }
+    memset(k_ipad, 0x36, 64); memset(k_opad, 0x5c, 64);
+    for (size_t i = 0; i < key_len; i++) { k_ipad[i] ^= key[i]; k_opad[i] ^= key[i]; }
+
+    SHA256_CTX ctx;
+    sha256_init(&ctx); sha256_update(&ctx, k_ipad, 64); memcpy(hkey->innerState, ctx.state, sizeof(ctx.state));
+    sha256_init(&ctx); sha256_update(&ctx, k_opad, 64); memcpy(hkey->outerState, ctx.state, sizeof(ctx.state));
+}
+
+void hmac_sha256_init(HmacContext *ctx, const HmacKey *hkey) {
+    ctx->key = hkey;
+    sha256_resume(&ctx->sha, hkey->innerState);
+}
+
+void hmac_sha256_update(HmacContext *ctx, const uint8_t *data, size_t data_len) {
+    sha256_update(&ctx->sha, data, data_len);
+}
+
+void hmac_sha256_final(HmacContext *ctx, uint8_t *output) {
+    uint8_t innerHash[32];
+    sha256_final(&ctx->sha, innerHash);
+    sha256_resume(&ctx->sha, ctx->key->outerState); sha256_update(&ctx->sha, innerHash, 32); sha256_final(&ctx->sha, output);
+}
+
+void hmac_sha256_with_key(const HmacKey *hkey, const uint8_t *data, size_t data_len, uint8_t *output) {
+    HmacContext ctx;
+    hmac_sha256_init(&ctx, hkey);
+    hmac_sha256_update(&ctx, data, data_len);
+    hmac_sha256_final(&ctx, output);
+}
+
+void hmac_sha256(const uint8_t *key, size_t key_len, const uint8_t *data, size_t data_len, uint8_t *output) {
+    HmacKey hkey;
+    hmac_sha256_key_init(&hkey, key, key_len);
+    hmac_sha256_with_key(&hkey, data, data_len, output);
+}
+
+void mac_key_init(MacKey *mkey, const uint8_t *secret, size_t secret_len) {
+    hmac_sha256_key_init(&mkey->hmac, secret, secret_len);
+
+    uint8_t digest[32];
+    SHA256_CTX ctx;
+    sha256_init(&ctx); sha256_update(&ctx, secret, secret_len); sha256_final(&ctx, digest);
+    memcpy(mkey->sip, digest, SIPHASH_KEY_LEN);
+}
+
+size_t mac_output_len(MacAlgorithm alg) {
+    switch (alg) {
+        case MAC_HMAC_SHA256: return 32;
+        case MAC_SIPHASH_2_4: return SIPHASH_OUTPUT_LEN;
+    }
+    return 0;
+}
+
+void mac_init(MacContext *ctx, MacAlgorithm alg, const MacKey *mkey) {
+    ctx->alg = alg;
+    if (alg == MAC_SIPHASH_2_4) siphash_init(&ctx->sip, mkey->sip);
+    else hmac_sha256_init(&ctx->hmac, &mkey->hmac);
+}
+
+void mac_update(MacContext *ctx, const uint8_t *data, size_t len) {
+    if (ctx->alg == MAC_SIPHASH_2_4) siphash_update(&ctx->sip, data, len);
+    else hmac_sha256_update(&ctx->hmac, data, len);
+}
+
+void mac_final(MacContext *ctx, uint8_t *output) {
+    if (ctx->alg == MAC_SIPHASH_2_4) siphash_final(&ctx->sip, output);
+    else hmac_sha256_final(&ctx->hmac, output);
+}
+
+void mac_compute(MacAlgorithm alg, const MacKey *mkey, const uint8_t *data, size_t len, uint8_t *output) {
+    MacContext ctx;
+    mac_init(&ctx, alg, mkey);
+    mac_update(&ctx, data, len);
+    mac_final(&ctx, output);
+}
+
+bool constant_time_equal(const uint8_t *a, const uint8_t *b, size_t len) {
+    uint8_t diff = 0;
+    for (size_t i = 0; i < len; i++) diff |= a[i] ^ b[i];
+    return diff == 0;
+}
+
+HmacBufferWriter::HmacBufferWriter(char *buffer, size_t capacity, HmacContext *hmac)
+    : _buffer(buffer), _capacity(capacity), _len(0), _hashed(0), _overflow(false), _hmac(hmac) {}
+
+size_t HmacBufferWriter::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t HmacBufferWriter::write(const uint8_t *data, size_t len) {
+    if (_len + len > _capacity) {
+        _overflow = true;
+        return 0;
+    }
+    memcpy(_buffer + _len, data, len);
+    _len += len;
+    // Hash whole blocks as soon as they are complete, the tail goes in finish()
+    size_t pending = (_len - _hashed) & ~(size_t)63;
+    if (pending) {
+        hmac_sha256_update(_hmac, (const uint8_t*)_buffer + _hashed, pending);
+        _hashed += pending;
+    }
+    return len;
+}
+
+void HmacBufferWriter::finish(uint8_t *output) {
+    hmac_sha256_update(_hmac, (const uint8_t*)_buffer + _hashed, _len - _hashed);
+    _hashed = _len;
+    hmac_sha256_final(_hmac, output);
+}
@@ -0,0 +1,91 @@
+#ifndef SECURITY_UTILS_H
+#define SECURITY_UTILS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sha256.h"
+#include "siphash.h"
+
+// Precomputed HMAC-SHA256 key: SHA-256 midstates after the ipad/opad blocks.
+// Build it once per secret, then every MAC costs 2 compressions instead of 4.
+struct HmacKey {
+    uint32_t innerState[8];
+    uint32_t outerState[8];
+};
+
+void hmac_sha256_key_init(HmacKey *hkey, const uint8_t *key, size_t key_len);
+void hmac_sha256_with_key(const HmacKey *hkey, const uint8_t *data, size_t data_len, uint8_t *output);
+
+// Incremental HMAC over a precomputed key: init, any number of updates, final
+struct HmacContext {
+    SHA256_CTX sha;
+    const HmacKey *key;
+};
+
+void hmac_sha256_init(HmacContext *ctx, const HmacKey *hkey);
+void hmac_sha256_update(HmacContext *ctx, const uint8_t *data, size_t data_len);
+void hmac_sha256_final(HmacContext *ctx, uint8_t *output);
+
+// Writer for serializeJson(): copies the output into a fixed buffer and feeds
+// it to the HMAC on the way, so a payload is signed in the pass that builds it.
+class HmacBufferWriter {
+public:
+    HmacBufferWriter(char *buffer, size_t capacity, HmacContext *hmac);
+    size_t write(uint8_t c);
+    size_t write(const uint8_t *data, size_t len);
+
+    // Hash the remaining bytes and produce the MAC of everything written
+    void finish(uint8_t *output);
+
+    size_t length() const { return _len; }
+    bool overflowed() const { return _overflow; }
+
+private:
+    char *_buffer;
+    size_t _capacity;
+    size_t _len;
+    size_t _hashed;
+    bool _overflow;
+    HmacContext *_hmac;
+};
+
+// --- MAC engines ---
+// The LoRa link picks its authenticator from the frame's protocol version
+// (see lora_protocol.h). HMAC-SHA256 is the default; SipHash-2-4 costs a
+// fraction of the cycles but only produces 8-byte tags.
+enum MacAlgorithm : uint8_t {
+    MAC_HMAC_SHA256 = 0,
+    MAC_SIPHASH_2_4 = 1
+};
+
+// Both keys derived once from the same secret.
+// SipHash key = first 16 bytes of SHA-256(secret).
+struct MacKey {
+    HmacKey hmac;
+    uint8_t sip[SIPHASH_KEY_LEN];
+};
+
+struct MacContext {
+    MacAlgorithm alg;
+    union {
+        HmacContext hmac;
+        SipHashContext sip;
+    };
+};
+
+void mac_key_init(MacKey *mkey, const uint8_t *secret, size_t secret_len);
+
+// Full output length of an engine (32 or 8 bytes), 0 if unknown
+size_t mac_output_len(MacAlgorithm alg);
+
+void mac_init(MacContext *ctx, MacAlgorithm alg, const MacKey *mkey);
+void mac_update(MacContext *ctx, const uint8_t *data, size_t len);
+void mac_final(MacContext *ctx, uint8_t *output);  // writes mac_output_len(alg) bytes
+void mac_compute(MacAlgorithm alg, const MacKey *mkey, const uint8_t *data, size_t len, uint8_t *output);
+
+// Constant-time comparison for MAC tags (no early exit on the first mismatch)
+bool constant_time_equal(const uint8_t *a, const uint8_t *b, size_t len);
+
+void hmac_sha256(const uint8_t *key, size_t key_len, const uint8_t *data, size_t data_len, uint8_t *output);
+
+#endif
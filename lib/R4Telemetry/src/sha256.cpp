@@ -0,0 +1,132 @@
+#include "sha256.h"
+#include <string.h>
+
+#define ROTRIGHT(a,b) (((a) >> (b)) | ((a) << (32-(b))))
+#define SIG0(x) (ROTRIGHT(x,7) ^ ROTRIGHT(x,18) ^ ((x) >> 3))
+#define SIG1(x) (ROTRIGHT(x,17) ^ ROTRIGHT(x,19) ^ ((x) >> 10))
+#define CH(x,y,z) ((z) ^ ((x) & ((y) ^ (z))))
+#define MAJ(x,y,z) (((x) & (y)) | ((z) & ((x) | (y))))
+#define EP0(x) (ROTRIGHT(x,2) ^ ROTRIGHT(x,13) ^ ROTRIGHT(x,22))
+#define EP1(x) (ROTRIGHT(x,6) ^ ROTRIGHT(x,11) ^ ROTRIGHT(x,25))
+
+static const uint32_t k[64] = {
+    0x428a2f98,0x71374491,0xb5c0fbcf,0xe9b5dba5,0x3956c25b,0x59f111f1,0x923f82a4,0xab1c5ed5,
+    0xd807aa98,0x12835b01,0x243185be,0x550c7dc3,0x72be5d74,0x80deb1fe,0x9bdc06a7,0xc19bf174,
+    0xe49b69c1,0xefbe4786,0x0fc19dc6,0x240ca1cc,0x2de92c6f,0x4a7484aa,0x5cb0a9dc,0x76f988da,
+    0x983e5152,0xa831c66d,0xb00327c8,0xbf597fc7,0xc6e00bf3,0xd5a79147,0x06ca6351,0x14292967,
+    0x27b70a85,0x2e1b2138,0x4d2c6dfc,0x53380d13,0x650a7354,0x766a0abb,0x81c2c92e,0x92722c85,
+    0xa2bfe8a1,0xa81a664b,0xc24b8b70,0xc76c51a3,0xd192e819,0xd6990624,0xf40e3585,0x106aa070,
+    0x19a4c116,0x1e376c08,0x2748774c,0x34b0bcb5,0x391c0cb3,0x4ed8aa4a,0x5b9cca4f,0x682e6ff3,
+    0x748f82ee,0x78a5636f,0x84c87814,0x8cc70208,0x90befffa,0xa4506ceb,0xbef9a3f7,0xc67178f2
+};
+
+// Unaligned big-endian load/store: memcpy + bswap compiles to LDR + REV on Cortex-M4
+static inline uint32_t load_be32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return v;
+#else
+    return __builtin_bswap32(v);
+#endif
+}
+
+static inline void store_be32(uint8_t *p, uint32_t v) {
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ != __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap32(v);
+#endif
+    memcpy(p, &v, 4);
+}
+
+// Message schedule kept as a rolling window of 16 words
+#define SCHED(i) (w[(i) & 15] += SIG1(w[((i) - 2) & 15]) + w[((i) - 7) & 15] + SIG0(w[((i) - 15) & 15]))
+
+// One round; the caller rotates the variable names instead of shifting them
+#define ROUND(a,b,c,d,e,f,g,h,i,wi) do { \
+    uint32_t t1 = (h) + EP1(e) + CH(e,f,g) + k[i] + (wi); \
+    (d) += t1; \
+    (h) = t1 + EP0(a) + MAJ(a,b,c); \
+} while (0)
+
+static void sha256_transform(SHA256_CTX *ctx, const uint8_t data[]) {
+    uint32_t w[16];
+    uint32_t a = ctx->state[0], b = ctx->state[1], c = ctx->state[2], d = ctx->state[3];
+    uint32_t e = ctx->state[4], f = ctx->state[5], g = ctx->state[6], h = ctx->state[7];
+    int i;
+
+    for (i = 0; i < 16; i += 8) {
+        ROUND(a,b,c,d,e,f,g,h, i + 0, w[i + 0] = load_be32(data + 4 * (i + 0)));
+        ROUND(h,a,b,c,d,e,f,g, i + 1, w[i + 1] = load_be32(data + 4 * (i + 1)));
+        ROUND(g,h,a,b,c,d,e,f, i + 2, w[i + 2] = load_be32(data + 4 * (i + 2)));
+        ROUND(f,g,h,a,b,c,d,e, i + 3, w[i + 3] = load_be32(data + 4 * (i + 3)));
+        ROUND(e,f,g,h,a,b,c,d, i + 4, w[i + 4] = load_be32(data + 4 * (i + 4)));
+        ROUND(d,e,f,g,h,a,b,c, i + 5, w[i + 5] = load_be32(data + 4 * (i + 5)));
+        ROUND(c,d,e,f,g,h,a,b, i + 6, w[i + 6] = load_be32(data + 4 * (i + 6)));
+        ROUND(b,c,d,e,f,g,h,a, i + 7, w[i + 7] = load_be32(data + 4 * (i + 7)));
+    }
+    for (; i < 64; i += 8) {
+        ROUND(a,b,c,d,e,f,g,h, i + 0, SCHED(i + 0));
+        ROUND(h,a,b,c,d,e,f,g, i + 1, SCHED(i + 1));
+        ROUND(g,h,a,b,c,d,e,f, i + 2, SCHED(i + 2));
+        ROUND(f,g,h,a,b,c,d,e, i + 3, SCHED(i + 3));
+        ROUND(e,f,g,h,a,b,c,d, i + 4, SCHED(i + 4));
+        ROUND(d,e,f,g,h,a,b,c, i + 5, SCHED(i + 5));
+        ROUND(c,d,e,f,g,h,a,b, i + 6, SCHED(i + 6));
+        ROUND(b,c,d,e,f,g,h,a, i + 7, SCHED(i + 7));
+    }
+
+    ctx->state[0] += a; ctx->state[1] += b; ctx->state[2] += c; ctx->state[3] += d;
+    ctx->state[4] += e; ctx->state[5] += f; ctx->state[6] += g; ctx->state[7] += h;
+}
+
+void sha256_init(SHA256_CTX *ctx) {
+    ctx->datalen = 0; ctx->bitlen = 0;
+    ctx->state[0] = 0x6a09e667; ctx->state[1] = 0xbb67ae85; ctx->state[2] = 0x3c6ef372; ctx->state[3] = 0xa54ff53a;
+    ctx->state[4] = 0x510e527f; ctx->state[5] = 0x9b05688c; ctx->state[6] = 0x1f83d9ab; ctx->state[7] = 0x5be0cd19;
+}
+
+void sha256_update(SHA256_CTX *ctx, const uint8_t data[], size_t len) {
+    // 1. Complete a partially filled block
+    if (ctx->datalen > 0) {
+        size_t fill = 64 - ctx->datalen;
+        if (fill > len) fill = len;
+        memcpy(ctx->data + ctx->datalen, data, fill);
+        ctx->datalen += fill;
+        data += fill;
+        len -= fill;
+        if (ctx->datalen < 64) return;
+        sha256_transform(ctx, ctx->data);
+        ctx->bitlen += 512;
+        ctx->datalen = 0;
+    }
+    // 2. Whole blocks straight from the caller's buffer
+    while (len >= 64) {
+        sha256_transform(ctx, data);
+        ctx->bitlen += 512;
+        data += 64;
+        len -= 64;
+    }
+    // 3. Keep the tail for the next call
+    if (len > 0) {
+        memcpy(ctx->data, data, len);
+        ctx->datalen = len;
+    }
+}
+
+void sha256_final(SHA256_CTX *ctx, uint8_t hash[]) {
+    uint32_t i = ctx->datalen;
+    ctx->bitlen += ctx->datalen * 8;
+
+    ctx->data[i++] = 0x80;
+    if (i > 56) {
+        memset(ctx->data + i, 0, 64 - i);
+        sha256_transform(ctx, ctx->data);
+        i = 0;
+    }
+    memset(ctx->data + i, 0, 56 - i);
+    store_be32(ctx->data + 56, (uint32_t)(ctx->bitlen >> 32));
+    store_be32(ctx->data + 60, (uint32_t)ctx->bitlen);
+    sha256_transform(ctx, ctx->data);
+
+    for (i = 0; i < 8; ++i) store_be32(hash + 4 * i, ctx->state[i]);
+}
@@ -0,0 +1,21 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+// Plain SHA-256 core, no Arduino dependency (also built by the host benchmark
+// in tests/sha256_bench.cpp).
+
+#include <stdint.h>
+#include <stddef.h>
+
+struct SHA256_CTX {
+    uint8_t data[64];
+    uint32_t datalen;
+    unsigned long long bitlen;
+    uint32_t state[8];
+};
+
+void sha256_init(SHA256_CTX *ctx);
+void sha256_update(SHA256_CTX *ctx, const uint8_t data[], size_t len);
+void sha256_final(SHA256_CTX *ctx, uint8_t hash[]);
+
+#endif
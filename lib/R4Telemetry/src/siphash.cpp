@@ -0,0 +1,71 @@
+#include "siphash.h"
+#include <string.h>
+
+#define ROTL64(x,b) (uint64_t)(((x) << (b)) | ((x) >> (64 - (b))))
+
+#define SIPROUND do { \
+    v0 += v1; v1 = ROTL64(v1, 13); v1 ^= v0; v0 = ROTL64(v0, 32); \
+    v2 += v3; v3 = ROTL64(v3, 16); v3 ^= v2; \
+    v0 += v3; v3 = ROTL64(v3, 21); v3 ^= v0; \
+    v2 += v1; v1 = ROTL64(v1, 17); v1 ^= v2; v2 = ROTL64(v2, 32); \
+} while (0)
+
+static inline uint64_t load_le64(const uint8_t *p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+static void siphash_compress(SipHashContext *ctx, uint64_t m) {
+    uint64_t v0 = ctx->v0, v1 = ctx->v1, v2 = ctx->v2, v3 = ctx->v3;
+    v3 ^= m;
+    SIPROUND; SIPROUND;
+    v0 ^= m;
+    ctx->v0 = v0; ctx->v1 = v1; ctx->v2 = v2; ctx->v3 = v3;
+}
+
+void siphash_init(SipHashContext *ctx, const uint8_t key[SIPHASH_KEY_LEN]) {
+    uint64_t k0 = load_le64(key);
+    uint64_t k1 = load_le64(key + 8);
+    ctx->v0 = 0x736f6d6570736575ULL ^ k0;
+    ctx->v1 = 0x646f72616e646f6dULL ^ k1;
+    ctx->v2 = 0x6c7967656e657261ULL ^ k0;
+    ctx->v3 = 0x7465646279746573ULL ^ k1;
+    ctx->buflen = 0;
+    ctx->totallen = 0;
+}
+
+void siphash_update(SipHashContext *ctx, const uint8_t *data, size_t len) {
+    ctx->totallen += (uint8_t)len;
+
+    if (ctx->buflen > 0) {
+        while (len > 0 && ctx->buflen < 8) {
+            ctx->buf[ctx->buflen++] = *data++;
+            len--;
+        }
+        if (ctx->buflen < 8) return;
+        siphash_compress(ctx, load_le64(ctx->buf));
+        ctx->buflen = 0;
+    }
+    while (len >= 8) {
+        siphash_compress(ctx, load_le64(data));
+        data += 8;
+        len -= 8;
+    }
+    memcpy(ctx->buf, data, len);
+    ctx->buflen = (uint8_t)len;
+}
+
+void siphash_final(SipHashContext *ctx, uint8_t out[SIPHASH_OUTPUT_LEN]) {
+    uint64_t b = (uint64_t)ctx->totallen << 56;
+    for (int i = ctx->buflen - 1; i >= 0; i--) b |= (uint64_t)ctx->buf[i] << (8 * i);
+
+    siphash_compress(ctx, b);
+
+    uint64_t v0 = ctx->v0, v1 = ctx->v1, v2 = ctx->v2, v3 = ctx->v3;
+    v2 ^= 0xff;
+    SIPROUND; SIPROUND; SIPROUND; SIPROUND;
+    uint64_t h = v0 ^ v1 ^ v2 ^ v3;
+
+    for (int i = 0; i < 8; i++) out[i] = (uint8_t)(h >> (8 * i));
+}
@@ -0,0 +1,24 @@
+#ifndef SIPHASH_H
+#define SIPHASH_H
+
+// SipHash-2-4 (64-bit output), no Arduino dependency.
+// One short frame costs a few SipRounds instead of 2-4 SHA-256 compressions.
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SIPHASH_KEY_LEN 16
+#define SIPHASH_OUTPUT_LEN 8
+
+struct SipHashContext {
+    uint64_t v0, v1, v2, v3;
+    uint8_t buf[8];
+    uint8_t buflen;
+    uint8_t totallen; // only the low byte of the length enters the final block
+};
+
+void siphash_init(SipHashContext *ctx, const uint8_t key[SIPHASH_KEY_LEN]);
+void siphash_update(SipHashContext *ctx, const uint8_t *data, size_t len);
+void siphash_final(SipHashContext *ctx, uint8_t out[SIPHASH_OUTPUT_LEN]);
+
+#endif
@@ -12,6 +12,10 @@
 #include "src/tasks/ui_task.h"
 #include "src/utils/data_manager.h"
 #include "src/utils/sleep_manager.h"
+#include "src/utils/node_keys.h"
+#include "src/utils/time_manager.h"
+#include "src/utils/crypto_bench.h"
+#include "src/utils/logger.h"
 
 void setup() {
   Serial.begin(115200);
@@ -21,7 +25,14 @@ void setup() {
   Serial.println("--- Initialisation du Gateway IoT ---");
 
   initDataManager();
+  initNodeKeys();
   SleepManager::begin();
+  initRtcSubSeconds();
+  logger_begin();
+
+#if CRYPTO_BENCHMARK
+  runCryptoBenchmark();
+#endif
 
   // Création des tâches FreeRTOS (Tailles optimisées pour le R4 WiFi)
   BaseType_t res;
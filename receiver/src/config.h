@@ -12,6 +12,10 @@
 #define MQTT_TOPIC_FABLAB "cesi/fablab"
 #define MQTT_TOPIC_HANDSHAKE_REQ "cesi/handshake/req"
 #define MQTT_TOPIC_HANDSHAKE_RES "cesi/handshake/res/cafeteria"
+// Noms MQTT { sensorId, id de handshake, topic }. Les autres capteurs publient
+// en "node<ID>" sur MQTT_TOPIC_NODE_PREFIX "<ID>".
+#define MQTT_NODE_NAMES { { CAFETERIA_ID, "cafeteria", MQTT_TOPIC_CAFET }, { FABLAB_ID, "fablab", MQTT_TOPIC_FABLAB } }
+#define MQTT_TOPIC_NODE_PREFIX "cesi/node"
 
 // LoRa Configuration (Pins pour Arduino R4 WiFi)
 #define LORA_SS_PIN 10
@@ -29,10 +33,51 @@
 #define LORA_SHARED_SECRET "IoT_Secure_P@ssw0rd_2026"
 #define GENESIS_HASH "0000000000000000000000000000000000000000000000000000000000000000"
 
+// Per-node LoRa secrets { sensorId, secret }. Unlisted nodes use LORA_SHARED_SECRET.
+#define LORA_NODE_KEYS { { FABLAB_ID, LORA_SHARED_SECRET } }
+#define MAX_NODE_KEYS 8
+
+// Shortest truncated tag accepted on LoRa frames (4, 8, 16 or 32 bytes)
+#define LORA_MIN_TAG_LEN 4
+
+// Admission des trames LoRa, avant la vérification du MAC
+#define LORA_OPEN_JOIN 1            // 0 = seuls les capteurs de LORA_NODE_KEYS sont admis
+#define LORA_DUP_CACHE_SIZE 8       // Trames acceptées récemment, ACK renvoyé tel quel aux doublons
+#define LORA_DUP_CACHE_TTL_MS 12000UL // > attente d'ACK + backoffs du capteur, < son intervalle de veille
+
+// Adaptive data rate (ACK v1/v2 des capteurs qui envoient leur réglage radio)
+#define LORA_ADR_MARGIN_DB 10       // Marge gardée au-dessus du plancher SNR du SF
+#define LORA_ADR_ADAPT_SF 0         // 1 = SF réseau adaptatif, 0 = SF7 fixe (puissance seule)
+#define LORA_ADR_SILENCE_MS 120000UL // Sans trame pendant ce délai: retour au SF par défaut
+
+// TDMA: beacon signé (heure, créneaux, ACK groupé) en début de supertrame.
+// 0 = pas de beacon, les capteurs émettent librement. A activer avec LORA_TDMA
+// sur les capteurs (ex. 15).
+#define LORA_BEACON_PERIOD_SEC 0    // Supertrame, = intervalle de veille des capteurs
+#define LORA_BEACON_SLOT_MS 400     // Trame au SF réseau + commande AT + gigue (multiple de 10 ms)
+#define LORA_BEACON_PROTOCOL 1      // 1 = HMAC-SHA256, 2 = SipHash-2-4 (celui des capteurs)
+#define LORA_BEACON_TAG_LEN 8
+#define LORA_BEACON_SECRET LORA_SHARED_SECRET
+
+// Set to 1 to print MAC/SHA-256 cycle counts at boot (DWT, before the scheduler starts)
+#define CRYPTO_BENCHMARK 0
+
+// Logs (0 = off, 1 = erreurs, 2 = warnings, 3 = info, 4 = debug).
+// Les appels au-dessus du niveau d'un module disparaissent à la compilation.
+#define LOG_LEVEL 3
+#define LOG_LEVEL_LORA LOG_LEVEL
+#define LOG_LEVEL_MODEM LOG_LEVEL
+#define LOG_LEVEL_MQTT LOG_LEVEL
+#define LOG_LEVEL_SENSOR LOG_LEVEL
+#define LOG_RING_SIZE 16 // Messages en attente (puissance de 2)
+
 // Sensor Configuration
 #define SENSOR_DHT_PIN 4
 #define SENSOR_DHT_TYPE DHT22 // Change to DHT11 if needed
 
+// Capteurs distants suivis par la passerelle (puissance de 2, ~60 octets chacun)
+#define MAX_REMOTE_NODES 32
+
 // Sensor Network IDs
 #define FABLAB_ID 1    // Sender (Remote)
 #define CAFETERIA_ID 2 // Receiver (Local)
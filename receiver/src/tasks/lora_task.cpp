@@ -1,244 +1,584 @@
 #include <Arduino.h>
 #include <Arduino_FreeRTOS.h>
 #include <RTC.h> // Required for Time Sync
+#include <security_utils.h>
+#include <lora_protocol.h>
+#include <hex_codec.h>
+#include <lora_batch.h>
+#include <lora_tlv.h>
 #include "../config.h"
 #include "../utils/data_manager.h"
-#include "../utils/security_utils.h"
+#include "../utils/node_keys.h"
+#include "../utils/lora_modem.h"
+#include "../utils/adr_engine.h"
+#include "../utils/time_manager.h"
+#include "../utils/dup_cache.h"
+#include "../utils/fec_decoder.h"
+
+#define LOG_MODULE "LoRa"
+#define LOG_MODULE_LEVEL LOG_LEVEL_LORA
+#include "../utils/logger.h"
 
 // --- CONFIGURATION ---
 const int LED_PIN = 13;
 const int LORA_BAUD_RATE = 9600;
 
+static LoRaModem loraModem;
+static uint8_t rxSf = LORA_DEFAULT_SF; // SF programmé dans le module
+
+#if LORA_BEACON_PERIOD_SEC > 0
+#if LORA_BEACON_PROTOCOL != LORA_PROTO_V1 && LORA_BEACON_PROTOCOL != LORA_PROTO_V2
+#error "LORA_BEACON_PROTOCOL must be 1 or 2"
+#endif
+#if LORA_BEACON_SLOT_MS % LORA_BEACON_SLOT_UNIT_MS != 0 || LORA_BEACON_SLOT_MS / LORA_BEACON_SLOT_UNIT_MS > 255
+#error "LORA_BEACON_SLOT_MS must be a multiple of 10 ms, up to 2550 ms"
+#endif
+static_assert(3 + loraBeaconBodyLen(LORA_BEACON_MAX_SLOTS) + LORA_BEACON_TAG_LEN <= LORA_MAX_FRAME_LEN,
+              "LORA_BEACON_TAG_LEN too long for a full beacon");
+
+// Créneaux attribués: ce qui tient dans la supertrame après le beacon et la
+// fenêtre d'accès libre. Au-delà, les capteurs restent en accès libre.
+#define BEACON_FIT_SLOTS (LORA_BEACON_PERIOD_SEC * 1000UL / LORA_BEACON_SLOT_MS - 1 - LORA_BEACON_JOIN_SLOTS)
+#if LORA_BEACON_PERIOD_SEC * 1000UL / LORA_BEACON_SLOT_MS < LORA_BEACON_JOIN_SLOTS + 2
+#error "LORA_BEACON_PERIOD_SEC too short for the beacon, one slot and the join window"
+#endif
+static const size_t BEACON_SLOTS = BEACON_FIT_SLOTS < LORA_BEACON_MAX_SLOTS ? BEACON_FIT_SLOTS : LORA_BEACON_MAX_SLOTS;
+
+static MacKey beaconKey;
+static uint32_t heardIds[256 / 32]; // Capteurs entendus depuis le dernier beacon (bit par ID)
+#endif
+
 // --- UTILS ---
 
-static String byteToHexString(uint8_t b) {
-    String s = String(b, HEX);
-    if (s.length() < 2) s = "0" + s;
-    return s;
+static bool initLoRaModule() {
+    LOG_INFO("Initialisation du module...");
+    if (!loraModem.begin(LORA_BAUD_RATE)) {
+        LOG_ERROR("ERREUR: démarrage du driver modem impossible.");
+        return false;
+    }
+    
+    // 1. Test de présence (AT)
+    // On essaie plusieurs fois
+    for (int i = 0; i < 3; i++) {
+        if (loraModem.command("AT", "+AT: OK") == MODEM_OK) {
+            LOG_INFO("Module détecté !");
+            
+            // 2. Configuration (chaque commande rend la main dès la réponse du module)
+            // 3. Passage en mode réception
+            if (loraModem.command("AT+MODE=TEST", "+MODE: TEST") == MODEM_OK &&
+                loraModem.configure(rxSf, LORA_MAX_TX_POWER) == MODEM_OK &&
+                loraModem.startReceive() == MODEM_OK) {
+                return true;
+            }
+            LOG_ERROR("Erreur de configuration du module.");
+        } else {
+            LOG_WARN("Pas de réponse... tentative %d", i + 1);
+        }
+        vTaskDelay(500 / portTICK_PERIOD_MS);
+    }
+    
+    LOG_ERROR("ERREUR CRITIQUE: Module LoRa non détecté.");
+    return false;
 }
 
-static void hexStringToBytes(const String &hexString, uint8_t *bytes, size_t len) {
-    for (size_t i = 0; i < len; i++) {
-        String byteStr = hexString.substring(i*2, i*2+2);
-        char byteChar[3] = {byteStr[0], byteStr[1], '\0'};
-        bytes[i] = (uint8_t)strtol(byteChar, NULL, 16);
+// Envoie une trame binaire (hex) puis repasse en réception. Pas d'émission au-delà
+// du budget de duty cycle; la passerelle est sourde de la commande TX au réarmement RX.
+static void transmitFrame(const uint8_t *frame, size_t len) {
+    uint32_t toaUs = loraModem.timeOnAirUs(len);
+    if (!reserveGatewayAirtime(toaUs)) {
+        LOG_WARN("Duty cycle atteint: trame de %u octets non émise.", len);
+        return;
+    }
+
+    uint32_t t0 = micros();
+    // Wait for TX DONE
+    if (loraModem.transmit(frame, len, loraModem.txTimeoutMs(len)) != MODEM_OK) {
+        LOG_ERROR("TX Error.");
     }
+
+    // Re-arm RX
+    loraModem.startReceive();
+    uint32_t blindUs = micros() - t0;
+    recordRxBlindWindow(blindUs);
+    LOG_DEBUG("TX %u octets: %lu us d'antenne, %lu us sans réception.", len, toaUs, blindUs);
+}
+
+// Signe une réponse v1/v2: tag = MAC(réponse || tag de la requête), même moteur et
+// même longueur de tag que la requête
+static size_t signReply(const LoraFrameView &req, uint8_t *reply, size_t replyLen) {
+    uint8_t fullTag[32];
+    MacContext mac;
+    mac_init(&mac, loraMacForVersion(req.version), getNodeKey(req.nodeId));
+    mac_update(&mac, reply, replyLen);
+    mac_update(&mac, req.tag, req.tagLen);
+    mac_final(&mac, fullTag);
+    memcpy(reply + replyLen, fullTag, req.tagLen);
+    return replyLen + req.tagLen;
 }
 
-static void sendAT(String cmd) {
-    Serial1.print(cmd + "\r\n");
+// Suit le SF réseau choisi par l'ADR (la réponse en cours est déjà partie à l'ancien SF)
+static void applyNetworkSf() {
+    uint8_t sf = adrNetworkSf();
+    if (sf == rxSf) return;
+    if (loraModem.configure(sf, LORA_MAX_TX_POWER) != MODEM_OK) {
+        LOG_ERROR("ADR: passage en SF%u impossible.", sf);
+        return;
+    }
+    LOG_INFO("ADR: réception en SF%u (avant SF%u).", sf, rxSf);
+    rxSf = sf;
+    loraModem.startReceive();
 }
 
-static String readResponse(uint16_t timeout = 500) {
-    String s = "";
-    uint32_t t0 = millis();
-    while (millis() - t0 < timeout) {
-        while (Serial1.available()) {
-            s += (char)Serial1.read();
+// Heure RTC à la milliseconde [TIME(4), MS(2)] dans le corps d'un ACK cumulatif
+static void putAckTime(uint8_t *body) {
+    uint16_t ms;
+    uint32_t now = getRtcTimeMs(&ms);
+    LoraCumAckBody::Time::put(body, now);
+    LoraCumAckBody::Ms::put(body, ms);
+}
+
+// adr = LORA_ADR_NONE pour un capteur sans ADR (ACK d'un seul octet)
+// Capteur avec LORA_HDR_CUM_ACK: ACK cumulatif [CUM, MAP, ADR] de sa fenêtre,
+// suivi de l'heure RTC à la milliseconde (le capteur se synchronise dessus).
+// L'ACK est gardé dans l'entrée du cache de doublons de la trame (dup, peut être NULL).
+static void sendAck(const LoraFrameView &frame, uint8_t adr, DupCacheEntry *dup) {
+    if (frame.version == LORA_PROTO_LEGACY) {
+        // Legacy: on renvoie le HMAC complet reçu
+        char hashStr[2 * LORA_FULL_TAG_LEN + 1];
+        hex_encode_cstr(frame.tag, LORA_FULL_TAG_LEN, hashStr);
+        LOG_DEBUG("Sending ACK: %s", hashStr);
+        dup_cache_set_ack(dup, frame.tag, LORA_FULL_TAG_LEN);
+        transmitFrame(frame.tag, LORA_FULL_TAG_LEN);
+        return;
+    }
+
+    // v1/v2: [HDR, ID, ACK, SEQ, (ADR)] + TAG ou [HDR, ID, ACK, CUM, MAP(2), ADR, TIME(4), MS(2)] + TAG
+    uint8_t ack[3 + LORA_ACK_TIME_BODY_LEN + LORA_FULL_TAG_LEN];
+    size_t len = 0;
+    ack[len++] = loraMakeHeader(frame.version, frame.tagLen);
+    ack[len++] = frame.nodeId;
+    ack[len++] = LORA_MSG_ACK;
+    uint8_t *body = ack + len;
+    if (frame.flags & LORA_HDR_CUM_ACK) {
+        uint8_t cum;
+        uint16_t map;
+        getRemoteAckState(frame.nodeId, &cum, &map);
+        LoraCumAckBody::Cum::put(body, cum);
+        LoraCumAckBody::Map::put(body, map);
+        LoraCumAckBody::Adr::put(body, adr);
+        putAckTime(body);
+        len += LORA_ACK_TIME_BODY_LEN;
+    } else {
+        LoraAckBody::Seq::put(body, frame.body[0]);
+        LoraAckBody::Adr::put(body, adr);
+        len += (adr != LORA_ADR_NONE) ? LORA_ACK_ADR_BODY_LEN : LORA_ACK_BODY_LEN;
+    }
+    len = signReply(frame, ack, len);
+
+    LOG_DEBUG("Sending ACK (v%u, tag %u octets)", frame.version, frame.tagLen);
+    dup_cache_set_ack(dup, ack, len);
+    transmitFrame(ack, len);
+}
+
+#if LORA_BEACON_PERIOD_SEC > 0
+static void markHeard(uint8_t nodeId) {
+    heardIds[nodeId >> 5] |= 1UL << (nodeId & 31);
+}
+
+// Beacon de début de supertrame: heure, un créneau par capteur connu (ordre de
+// la table) et ACK groupé des trames reçues depuis le beacon précédent
+static void sendBeacon() {
+    RTCTime current;
+    RTC.getTime(current);
+    uint32_t now = current.getUnixTime();
+
+    uint8_t frame[LORA_MAX_FRAME_LEN];
+    size_t len = 0;
+    frame[len++] = loraMakeHeader(LORA_BEACON_PROTOCOL, LORA_BEACON_TAG_LEN);
+    frame[len++] = LORA_GATEWAY_ID;
+    frame[len++] = LORA_MSG_BEACON;
+    uint8_t *body = frame + len;
+    LoraBeaconBody::Time::put(body, now);
+    LoraBeaconBody::Period::put(body, LORA_BEACON_PERIOD_SEC);
+    LoraBeaconBody::Slot::put(body, LORA_BEACON_SLOT_MS / LORA_BEACON_SLOT_UNIT_MS);
+
+    uint8_t *ids = body + LoraBeaconBody::ids;
+    uint8_t count = (uint8_t)getRemoteNodeIds(ids, BEACON_SLOTS);
+    LoraBeaconBody::Count::put(body, count);
+    len += LoraBeaconBody::ids + count;
+
+    uint8_t *ackMap = frame + len;
+    memset(ackMap, 0, (count + 7) / 8);
+    uint8_t acked = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if ((heardIds[ids[i] >> 5] >> (ids[i] & 31)) & 1) {
+            ackMap[i >> 3] |= 1 << (i & 7);
+            acked++;
         }
-        delay(1); 
     }
-    return s;
+    len += (count + 7) / 8;
+    memset(heardIds, 0, sizeof(heardIds));
+
+    uint8_t fullTag[32];
+    mac_compute(loraMacForVersion(LORA_BEACON_PROTOCOL), &beaconKey, frame, len, fullTag);
+    memcpy(frame + len, fullTag, LORA_BEACON_TAG_LEN);
+    len += LORA_BEACON_TAG_LEN;
+
+    LOG_INFO("Beacon: %lu, %u créneaux, %u acquittés (%u octets)", now, count, acked, len);
+    transmitFrame(frame, len);
 }
+#else
+static void markHeard(uint8_t) {}
+#endif
+
+static void sendTimeResponse(const LoraFrameView &frame) {
+    // Get Current Time
+    RTCTime current;
+    RTC.getTime(current);
+    uint32_t now = current.getUnixTime();
+    LOG_INFO("  Current Unix Time: %lu", now);
+
+    uint8_t resp[7 + LORA_FULL_TAG_LEN];
+    size_t len;
+    if (frame.version == LORA_PROTO_LEGACY) {
+        // Format: [ID (Target), TYPE (4), TIME (4 Bytes), HMAC (32 Bytes)]
+        resp[0] = frame.nodeId; // Target = Requestor ID
+        resp[1] = LORA_MSG_TIME_RESP;
+        LoraTimeBody::Time::put(resp + 2, now);
+        hmac_sha256_with_key(&getNodeKey(frame.nodeId)->hmac, resp, 6, resp + 6);
+        len = 6 + LORA_FULL_TAG_LEN;
+    } else {
+        // Format v1/v2: [HDR, ID, TYPE (4), TIME (4 Bytes)] + TAG lié à la requête (nonce)
+        resp[0] = loraMakeHeader(frame.version, frame.tagLen);
+        resp[1] = frame.nodeId;
+        resp[2] = LORA_MSG_TIME_RESP;
+        LoraTimeBody::Time::put(resp + 3, now);
+        len = signReply(frame, resp, 7);
+    }
 
-static bool initLoRaModule() {
-    Serial.println("[LoRa] Initialisation du module...");
-    Serial1.begin(LORA_BAUD_RATE);
-    
-    // 1. Test de présence (AT)
-    // On essaie plusieurs fois
-    for (int i = 0; i < 3; i++) {
-        // Vider le buffer
-        while(Serial1.available()) Serial1.read();
-        
-        sendAT("AT");
-        String resp = readResponse(1000);
-        
-        if (resp.indexOf("OK") != -1) {
-            Serial.println("[LoRa] Module détecté !");
-            
-            // 2. Configuration
-            sendAT("AT+MODE=TEST"); delay(100); readResponse();
-            sendAT("AT+TEST=RFCFG,868,SF7,125,12,15,14"); delay(100); readResponse();
-            
-            // 3. Passage en mode réception
-            sendAT("AT+TEST=RXLRPKT");
-            delay(200);
-            readResponse(); // Flush confirm
+    LOG_INFO("Sending Time Response...");
+    transmitFrame(resp, len);
+}
+
+// ACK d'une trame DATA/BATCH (sauf LORA_HDR_NO_ACK). ADR: marge SNR mesurée au réglage annoncé par le
+// capteur (nodeAdr), recommandation renvoyée dans l'ACK puis SF réseau suivi.
+static void acknowledge(const LoraFrameView &frame, uint8_t nodeAdr, int snr, DupCacheEntry *dup) {
+    uint8_t adr = LORA_ADR_NONE;
+    if (nodeAdr != LORA_ADR_NONE) {
+        adr = adrOnUplink(frame.nodeId, nodeAdr, snr);
+        LOG_INFO("  ADR: capteur SF%u / %d dBm -> SF%u / %d dBm", loraAdrSf(nodeAdr),
+                 loraAdrPowerDbm(nodeAdr), loraAdrSf(adr), loraAdrPowerDbm(adr));
+    }
+    // Le capteur n'écoute pas: pas d'ACK (son prochain ACK cumulatif couvrira cette trame)
+    if (frame.flags & LORA_HDR_NO_ACK) return;
+    sendAck(frame, adr, dup);
+    applyNetworkSf();
+}
 
-            return true;
+// --- ADMISSION ---
+// Filtre d'entrée, sans calcul de MAC: les retransmissions et le trafic parasite
+// ne coûtent plus une vérification HMAC chacun. Tâche LoRa seule.
+static struct {
+    uint32_t rejected;    // Refusées avant le MAC (émetteur, type, longueur, séquence)
+    uint32_t duplicates;  // Retransmissions servies par le cache
+} admission;
+
+// NULL si la trame peut être vérifiée, sinon la raison du refus
+static const char *admitFrame(const LoraFrameView &frame) {
+    if (frame.nodeId == LORA_GATEWAY_ID || frame.nodeId == CAFETERIA_ID) return "ID de la passerelle";
+#if !LORA_OPEN_JOIN
+    if (!hasNodeKey(frame.nodeId)) return "capteur hors LORA_NODE_KEYS";
+#endif
+    if (!canTrackRemoteNode(frame.nodeId)) return "table des capteurs pleine";
+
+    bool v1 = frame.version != LORA_PROTO_LEGACY;
+    switch (frame.type) {
+    case LORA_MSG_DATA:
+        if (frame.bodyLen != LORA_DATA_BODY_LEN && !(v1 && frame.bodyLen == LORA_DATA_ADR_BODY_LEN)) return "longueur DATA";
+        break;
+    case LORA_MSG_BATCH:
+        if (!v1 || frame.bodyLen <= LORA_BATCH_PREFIX_LEN) return "longueur BATCH";
+        break;
+    case LORA_MSG_MEASURE:
+        if (!v1 || frame.bodyLen < LORA_MEASURE_PREFIX_LEN ||
+            !lora_tlv_valid(frame.body + LORA_MEASURE_PREFIX_LEN, frame.bodyLen - LORA_MEASURE_PREFIX_LEN)) {
+            return "enregistrements MEASURE";
         }
-        Serial.println("[LoRa] Pas de réponse... tentative " + String(i+1));
-        delay(500);
+        break;
+    case LORA_MSG_TIME_REQ:
+        return frame.bodyLen == LORA_TIME_BODY_LEN ? NULL : "longueur TIME_REQ";
+    case LORA_MSG_PARITY:
+        return (v1 && frame.bodyLen == LORA_PARITY_BODY_LEN) ? NULL : "longueur PARITY";
+    default:
+        return "type inattendu";
     }
-    
-    Serial.println("[LoRa] ERREUR CRITIQUE: Module LoRa non détecté.");
-    return false;
+
+    // Déjà reçue et aucune réponse attendue: rien à faire. La séquence 0 passe
+    // (capteur redémarré, voir acceptSequence).
+    if ((frame.flags & LORA_HDR_NO_ACK) && frame.body[0] != 0 &&
+        peekRemoteSequence(frame.nodeId, frame.body[0]) == SEQ_DUPLICATE) {
+        return "séquence déjà reçue";
+    }
+    return NULL;
 }
 
-static void sendAck(const uint8_t *hashToSend) {
-// ... (reste des fonctions inchangées)
-    String hashStr = hashToString(hashToSend);
-    Serial.println("[LoRa] Sending ACK: " + hashStr);
-    
-    // Clear buffer
-    while(Serial1.available()) Serial1.read();
+// Retransmission d'une trame déjà acceptée (ACK perdu): ni MAC ni comptage, son
+// ACK repart. Celui qui porte l'heure est rafraîchi et re-signé (un MAC au lieu
+// de deux) sur le tag vérifié à l'acceptation, gardé entier par le cache: le
+// capteur la mesure sur cet échange-ci.
+static void replayAck(const LoraFrameView &frame, DupCacheEntry *dup) {
+    admission.duplicates++;
+    markHeard(frame.nodeId);
+    LOG_INFO("DOUBLON: source %u, seq %u (%lu servis par le cache)", frame.nodeId, frame.body[0], admission.duplicates);
+    if (dup->ackLen == 0 || (frame.flags & LORA_HDR_NO_ACK)) return;
+
+    if ((frame.flags & LORA_HDR_CUM_ACK) && dup->ackLen == 3 + LORA_ACK_TIME_BODY_LEN + frame.tagLen) {
+        LoraFrameView accepted = frame;
+        accepted.tag = dup->tag;
+        accepted.tagLen = dup->tagLen;
+        putAckTime(dup->ack + 3);
+        signReply(accepted, dup->ack, 3 + LORA_ACK_TIME_BODY_LEN);
+    }
+    transmitFrame(dup->ack, dup->ackLen);
+}
 
-    // Send ACK
-    sendAT("AT+TEST=TXLRPKT,\"" + hashStr + "\"");
-    
-    // Wait for TX DONE
-    uint32_t tStart = millis();
-    while(millis() - tStart < 2000) {
-        String line = Serial1.readStringUntil('\n');
-        if (line.indexOf("TX DONE") != -1) break;
+// Fenêtre du capteur. Une séquence 0 déjà vue, absente du cache et loin derrière
+// la plus récente est un capteur redémarré (compteur remis à 0 à la mise sous
+// tension), pas un doublon. Juste derrière (compteur conservé, passage 255 -> 0),
+// c'est une retransmission tardive: un doublon.
+static SeqStatus acceptSequence(uint8_t nodeId, uint8_t sequence) {
+    SeqStatus status = acceptRemoteSequence(nodeId, sequence);
+    if (status == SEQ_DUPLICATE && sequence == 0 && restartRemoteSequence(nodeId, sequence)) {
+        fec_reset(nodeId);
+        return SEQ_NEW;
     }
+    return status;
+}
 
-    // Re-arm RX
-    sendAT("AT+TEST=RXLRPKT");
+// Lecture d'une trame DATA (taille fixe) ou MEASURE (enregistrements TLV)
+struct UplinkReading {
+    uint8_t sequence;
+    uint8_t adr;          // LORA_ADR_NONE si la trame n'en porte pas
+    int16_t temperature;  // 1/100 °C, SENSOR_VALUE_NAN si absente
+    int16_t humidity;     // 1/100 %
+    uint32_t capturedAt;  // Heure Unix de la mesure, 0 = à la réception
+    uint16_t batteryMv;   // 0 = pas de mesure
+    uint16_t status;      // LORA_STATUS_*
+    bool hasStatus;
+};
+
+static void decodeReading(const LoraFrameView &frame, UplinkReading *r) {
+    memset(r, 0, sizeof(*r));
+    r->sequence = frame.body[0];
+    if (frame.type == LORA_MSG_DATA) {
+        r->temperature = LoraDataBody::Temperature::get(frame.body);
+        r->humidity = LoraDataBody::Humidity::get(frame.body);
+        if (frame.version != LORA_PROTO_LEGACY && frame.bodyLen == LORA_DATA_ADR_BODY_LEN) {
+            r->adr = LoraDataBody::Adr::get(frame.body);
+        }
+        return;
+    }
+
+    // MEASURE: un canal absent reste inconnu, un type inconnu (firmware plus récent) est sauté
+    r->adr = LoraPrefixBody::Adr::get(frame.body);
+    r->temperature = SENSOR_VALUE_NAN;
+    r->humidity = SENSOR_VALUE_NAN;
+    const uint8_t *records = frame.body + LORA_MEASURE_PREFIX_LEN;
+    size_t len = frame.bodyLen - LORA_MEASURE_PREFIX_LEN;
+    size_t offset = 0;
+    LoraTlvRecord rec;
+    while (lora_tlv_next(records, len, &offset, &rec)) {
+        switch (rec.type) {
+        case LORA_TLV_TEMPERATURE:
+            if (rec.len == 2) r->temperature = (int16_t)lora_tlv_u16(rec);
+            break;
+        case LORA_TLV_HUMIDITY:
+            if (rec.len == 2) r->humidity = (int16_t)lora_tlv_u16(rec);
+            break;
+        case LORA_TLV_TIME:
+            r->capturedAt = lora_tlv_u32(rec);
+            break;
+        case LORA_TLV_BATTERY:
+            r->batteryMv = lora_tlv_u16(rec);
+            break;
+        case LORA_TLV_STATUS:
+            r->hasStatus = rec.len == 2;
+            r->status = lora_tlv_u16(rec);
+            break;
+        default:
+            break;
+        }
+    }
 }
 
-// --- GLOBALS ---
-static int lastRssi = 0;
-static int lastSnr = 0;
-
-static void processRxLine(String line) {
-    // 1. Detection RSSI/SNR (Parfois sur une ligne separate ou incluse)
-    if (line.indexOf("RSSI:") != -1) {
-        int rIdx = line.indexOf("RSSI:");
-        int sIdx = line.indexOf("SNR:");
-        if (rIdx != -1) lastRssi = line.substring(rIdx + 5).toInt();
-        if (sIdx != -1) lastSnr = line.substring(sIdx + 4).toInt();
-        
-        // Si la ligne ne contient que ca, on s'arrete
-        if (line.indexOf("RX \"") == -1) return;
+// Trame PARITY: une trame DATA perdue du groupe est reconstruite et comptée comme
+// reçue, sans retransmission. Perdue en fin de groupe: c'est la lecture la plus
+// récente, elle est affichée.
+static void processParity(const LoraFrameView &frame, int rssi, int snr) {
+    uint8_t sequence;
+    uint8_t reading[LORA_FEC_PAYLOAD_LEN];
+    if (!fec_on_parity(frame.nodeId, frame.body, &sequence, reading)) {
+        LOG_DEBUG("PARITE: source %u, seq %u+%u, rien à reconstruire", frame.nodeId,
+                  LoraParityBody::First::get(frame.body), LoraParityBody::Count::get(frame.body));
+        return;
+    }
+
+    SeqStatus status = acceptRemoteSequence(frame.nodeId, sequence);
+    if (status == SEQ_DUPLICATE) return;
+    int16_t tRaw = LoraFecReading::Temperature::get(reading);
+    int16_t hRaw = LoraFecReading::Humidity::get(reading);
+    LOG_INFO("TRAME RECONSTRUITE (FEC): source %u, seq %u, %f C, %f %%", frame.nodeId, sequence,
+             centiToFloat(tRaw), centiToFloat(hRaw));
+    if (status == SEQ_RECOVERED) recordRecoveredPacket(frame.nodeId);
+    else updateRemoteData(frame.nodeId, centiToFloat(tRaw), centiToFloat(hRaw), rssi, snr, sequence);
+    markHeard(frame.nodeId);
+}
+
+// Trame décodée par le driver modem (RSSI/SNR de la ligne "+TEST: LEN:..." associée)
+static void processPacket(const LoraRxPacket &packet) {
+    uint32_t latencyUs = micros() - packet.timestampUs; // Fin de ligne (ISR UART) -> traitement
+    const uint8_t *payload = packet.frame;
+    int rssi = packet.rssi;
+    int snr = packet.snr;
+
+    LoraFrameView frame;
+    if (!loraParseFrame(payload, packet.len, &frame)) {
+        LOG_WARN("Ignored: Unknown header / frame too short (%u)", packet.len);
+        return;
+    }
+    if (frame.tagLen < LORA_MIN_TAG_LEN) {
+        LOG_WARN("Ignored: Tag too short (%u)", frame.tagLen);
+        return;
+    }
+    const char *refused = admitFrame(frame);
+    if (refused != NULL) {
+        admission.rejected++;
+        LOG_DEBUG("Ignored: source %u, type %u: %s", frame.nodeId, frame.type, refused);
+        return;
+    }
+
+    uint32_t airtimeUs = loraModem.timeOnAirUs(packet.len);
+    DupCacheEntry *dup = NULL;
+    if (frame.type != LORA_MSG_TIME_REQ) {
+        dup = dup_cache_find(frame, millis());
+        if (dup != NULL) {
+            recordRemoteAirtime(frame.nodeId, airtimeUs);
+            replayAck(frame, dup);
+            return;
+        }
     }
 
-    int rxIndex = line.indexOf("+TEST: RX \"");
-    if (rxIndex == -1) return;
+    // Verify MAC (moteur selon la version, clés précalculées par node ID),
+    // tag tronqué comparé en temps constant
+    uint8_t calculatedHash[32];
+    mac_compute(loraMacForVersion(frame.version), getNodeKey(frame.nodeId), payload, frame.signedLen, calculatedHash);
 
-    int firstQuote = line.indexOf('"', rxIndex);
-    int lastQuote = line.lastIndexOf('"');
+    if (!constant_time_equal(frame.tag, calculatedHash, frame.tagLen)) {
+        LOG_ERROR("ERROR: Invalid MAC signature.");
+        return;
+    }
+    recordRemoteAirtime(frame.nodeId, airtimeUs);
+    if (frame.type != LORA_MSG_TIME_REQ) dup = dup_cache_insert(frame, millis());
+
+    // Type et longueur déjà validés par admitFrame
+    if (frame.type == LORA_MSG_DATA || frame.type == LORA_MSG_MEASURE) {
+        // --- TYPE 2: DATA REPORT / TYPE 9: MEASURE (enregistrements TLV) ---
+        UplinkReading r;
+        decodeReading(frame, &r);
+        uint8_t sensorId = frame.nodeId;
+        uint8_t sequence = r.sequence;
+        float tempVal = centiToFloat(r.temperature);
+        float humVal = centiToFloat(r.humidity);
+
+        // Retransmission d'une trame déjà comptée perdue: une lecture plus récente est
+        // déjà affichée, on ne corrige que les compteurs. Doublon sorti du cache:
+        // ACK seulement, rien n'est compté deux fois.
+        SeqStatus status = acceptSequence(sensorId, sequence);
+        uint8_t fecReading[LORA_FEC_PAYLOAD_LEN];
+        LoraFecReading::Temperature::put(fecReading, r.temperature);
+        LoraFecReading::Humidity::put(fecReading, r.humidity);
+        fec_on_data(sensorId, sequence, fecReading);
+        if (status != SEQ_NEW) {
+            if (status == SEQ_RECOVERED) {
+                LOG_INFO("PAQUET DATA RETRANSMIS: source %u, seq %u", sensorId, sequence);
+                recordRecoveredPacket(sensorId);
+            } else {
+                LOG_INFO("PAQUET DATA EN DOUBLE: source %u, seq %u", sensorId, sequence);
+            }
+            markHeard(sensorId);
+            acknowledge(frame, r.adr, snr, dup);
+            return;
+        }
 
-    if (firstQuote != -1 && lastQuote != -1 && lastQuote > firstQuote) {
-        String hexContent = line.substring(firstQuote + 1, lastQuote);
-        int len = hexContent.length();
+        // Journal différé: quelques dizaines de cycles par appel, l'ACK n'attend plus l'UART
+        LOG_INFO("PAQUET %s RECU: source %u, seq %u, v%u / tag %u octets", frame.type == LORA_MSG_DATA ? "DATA" : "MEASURE",
+                 sensorId, sequence, frame.version, frame.tagLen);
+        LOG_INFO("  Temperature %f C, Humidite %f %%, RSSI / SNR %d / %d", tempVal, humVal, rssi, snr);
+        if (frame.type == LORA_MSG_MEASURE) {
+            LOG_INFO("  Batterie %u mV, etat %04x, mesure %lu", r.batteryMv, r.status, r.capturedAt);
+        }
+        LoRaModemStats modemStats = loraModem.stats();
+        LOG_INFO("  Lignes UART %lu (rejetées %lu, overruns %lu, max %lu us), latence RX %lu us",
+                 modemStats.lines, modemStats.rejected, modemStats.uartOverruns, modemStats.maxLineUs, latencyUs);
+        LOG_INFO("  Admission: %lu refusées avant MAC, %lu doublons", admission.rejected, admission.duplicates);
+
+        if (frame.type == LORA_MSG_MEASURE) setRemoteHealth(sensorId, r.batteryMv, r.hasStatus, r.status);
+        updateRemoteData(sensorId, tempVal, humVal, rssi, snr, sequence, r.capturedAt);
+        markHeard(sensorId);
+        setLoraStatus(true);
         
-        // Si le RSSI n'a pas été trouvé plus haut (fallback parsing fin de ligne)
-        int rssi = lastRssi;
-        int snr = lastSnr;
-
-        // On accepte 76 (Time Request) ou 78 (Data Report)
-        if (len == 76 || len == 78) { 
-            int payloadLen = len / 2;
-            uint8_t payload[40]; 
-            hexStringToBytes(hexContent, payload, payloadLen);
-
-            int dataLen = payloadLen - 32;
-            uint8_t dataPart[8];
-            uint8_t receivedHash[32];
-            
-            memcpy(dataPart, payload, dataLen);
-            memcpy(receivedHash, payload + dataLen, 32);
-
-            // Verify HMAC
-            uint8_t calculatedHash[32];
-            hmac_sha256(
-                (const uint8_t*)LORA_SHARED_SECRET, strlen(LORA_SHARED_SECRET),
-                dataPart, dataLen, 
-                calculatedHash
-            );
-
-            if (memcmp(receivedHash, calculatedHash, 32) == 0) {
-                // Determine TYPE
-                uint8_t msgType = dataPart[1];
-
-                if (msgType == 2 && dataLen == 7) { 
-                    // --- TYPE 2: DATA REPORT ---
-                    uint8_t sensorId = dataPart[0];
-                    uint8_t sequence = dataPart[2];
-                    
-                    int16_t tRaw = (int16_t)(dataPart[3] | (dataPart[4] << 8));
-                    int16_t hRaw = (int16_t)(dataPart[5] | (dataPart[6] << 8));
-                    
-                    // On décode 0x7FFF comme NAN (Erreur capteur)
-                    float tempVal = (tRaw == 0x7FFF) ? NAN : tRaw / 100.0;
-                    float humVal = (hRaw == 0x7FFF) ? NAN : hRaw / 100.0;
-
-                    Serial.println("\n========== [LoRa] PAQUET DATA RECU ==========");
-                    Serial.print("  Source ID   : "); Serial.print(sensorId);
-                    if (sensorId == CAFETERIA_ID)      Serial.println(" (CAFETERIA)");
-                    else if (sensorId == FABLAB_ID)    Serial.println(" (FABLAB)");
-                    else                               Serial.println(" (INCONNU)");
-                    Serial.print("  Sequence    : "); Serial.println(sequence);
-                    Serial.print("  Temperature : "); Serial.print(tempVal); Serial.println(" C");
-                    Serial.print("  Humidite    : "); Serial.print(humVal); Serial.println(" %");
-                    Serial.print("  RSSI / SNR  : "); Serial.print(rssi); Serial.print(" / "); Serial.println(snr);
-                    Serial.println("=============================================");
-
-                    updateRemoteData(sensorId, tempVal, humVal, rssi, snr, sequence);
-                    setLoraStatus(true);
-                    
-                    digitalWrite(LED_PIN, HIGH);
-                    delay(50);
-                    digitalWrite(LED_PIN, LOW);
-
-                    // Send Standard ACK (Hash)
-                    sendAck(receivedHash);
-
-                } else if (msgType == 3 && dataLen == 6) { 
-                    // --- TYPE 3: TIME REQUEST ---
-                    Serial.println("\n[LoRa] TIME SYNC REQUEST RECEIVED.");
-                    
-                    // Get Current Time
-                    RTCTime current;
-                    RTC.getTime(current);
-                    uint32_t now = current.getUnixTime();
-                    Serial.print("  Current Unix Time: "); Serial.println(now);
-
-                    // Prepare Response Packet (Type 4)
-                    // Format: [ID (Target), TYPE (4), TIME (4 Bytes), HMAC (32 Bytes)]
-                    uint8_t respPayload[6];
-                    respPayload[0] = dataPart[0]; // Target = Requestor ID
-                    respPayload[1] = 4;           // Type 4 = Time Response
-                    respPayload[2] = (uint8_t)(now & 0xFF);
-                    respPayload[3] = (uint8_t)((now >> 8) & 0xFF);
-                    respPayload[4] = (uint8_t)((now >> 16) & 0xFF);
-                    respPayload[5] = (uint8_t)((now >> 24) & 0xFF);
-
-                    // Sign
-                    uint8_t respHmac[32];
-                    hmac_sha256((const uint8_t*)LORA_SHARED_SECRET, strlen(LORA_SHARED_SECRET), respPayload, 6, respHmac);
-
-                    // To Hex
-                    String hexResp = "";
-                    for(int i=0; i<6; i++) hexResp += byteToHexString(respPayload[i]);
-                    for(int i=0; i<32; i++) hexResp += byteToHexString(respHmac[i]);
-
-                    // Send
-                    Serial.println("[LoRa] Sending Time Response...");
-                    while(Serial1.available()) Serial1.read();
-                    sendAT("AT+TEST=TXLRPKT,\"" + hexResp + "\"");
-                    
-                    // Wait TX DONE
-                    uint32_t tStart = millis();
-                    while(millis() - tStart < 2000) {
-                        String line = Serial1.readStringUntil('\n');
-                        if (line.indexOf("TX DONE") != -1) break;
-                    }
-                    
-                    // Re-arm RX
-                    sendAT("AT+TEST=RXLRPKT");
-                }
+        digitalWrite(LED_PIN, HIGH);
+        delay(50);
+        digitalWrite(LED_PIN, LOW);
+
+        acknowledge(frame, r.adr, snr, dup);
+
+    } else if (frame.type == LORA_MSG_BATCH) {
+        // --- TYPE 6: BATCH (plusieurs lectures horodatées, un seul MAC/ACK) ---
+        static LoraReading readings[LORA_BATCH_MAX_READINGS];
+        uint8_t sequence = LoraPrefixBody::Seq::get(frame.body);
+        int count = lora_batch_decode(frame.body + LORA_BATCH_PREFIX_LEN, frame.bodyLen - LORA_BATCH_PREFIX_LEN,
+                                      readings, LORA_BATCH_MAX_READINGS);
+        if (count < 0) {
+            LOG_WARN("Ignored: malformed batch (seq %u)", sequence);
+            return;
+        }
 
-            } else {
-                Serial.println("[LoRa] ERROR: Invalid HMAC signature.");
+        SeqStatus status = acceptSequence(frame.nodeId, sequence);
+        if (status == SEQ_DUPLICATE) {
+            LOG_INFO("PAQUET BATCH EN DOUBLE: source %u, seq %u", frame.nodeId, sequence);
+            markHeard(frame.nodeId);
+            acknowledge(frame, LoraPrefixBody::Adr::get(frame.body), snr, dup);
+            return;
+        }
+        LOG_INFO("PAQUET BATCH RECU: source %u, seq %u, %d lectures, RSSI / SNR %d / %d",
+                 frame.nodeId, sequence, count, rssi, snr);
+        // Une trame, un compteur: la première lecture compte la trame (ou la
+        // retransmission), les suivantes ne font que l'historique
+        for (int i = 0; i < count; i++) {
+            float tempVal = centiToFloat(readings[i].temperature);
+            float humVal = centiToFloat(readings[i].humidity);
+            LOG_DEBUG("  %lu: %f C, %f %%", readings[i].time, tempVal, humVal);
+            if (i == 0 && status == SEQ_NEW) {
+                updateRemoteData(frame.nodeId, tempVal, humVal, rssi, snr, sequence, readings[i].time);
+                continue;
             }
-        } else {
-             Serial.println("[LoRa] Ignored: Invalid length (" + String(len) + ")");
+            if (i == 0) recordRecoveredPacket(frame.nodeId);
+            pushRemoteReading(frame.nodeId, tempVal, humVal, readings[i].time);
         }
-    } else {
-        Serial.println("[LoRa] Parse error.");
+        markHeard(frame.nodeId);
+        setLoraStatus(true);
+
+        acknowledge(frame, LoraPrefixBody::Adr::get(frame.body), snr, dup);
+
+    } else if (frame.type == LORA_MSG_PARITY) {
+        // --- TYPE 8: PARITY (XOR des lectures d'un groupe de trames DATA) ---
+        processParity(frame, rssi, snr);
+
+    } else if (frame.type == LORA_MSG_TIME_REQ) { 
+        // --- TYPE 3: TIME REQUEST ---
+        LOG_INFO("TIME SYNC REQUEST RECEIVED.");
+        sendTimeResponse(frame);
     }
 }
 
@@ -253,23 +593,41 @@ void loraTask(void *pvParameters) {
             break; // Sortie de la boucle d'init pour aller vers la boucle RX
         } else {
             setLoraStatus(false);
-            Serial.println("[LoRaTask] Nouvelle tentative dans 5s...");
+            LOG_WARN("Nouvelle tentative dans 5s...");
             vTaskDelay(5000 / portTICK_PERIOD_MS);
         }
     }
 
-    Serial.println("[LoRaTask] En attente de paquets...");
+    LOG_INFO("En attente de paquets...");
+
+#if LORA_BEACON_PERIOD_SEC > 0
+    mac_key_init(&beaconKey, (const uint8_t*)LORA_BEACON_SECRET, strlen(LORA_BEACON_SECRET));
+    uint32_t nextBeaconMs = millis();
+#endif
 
+    // Bloque jusqu'à la prochaine trame (plus de polling de Serial1) ou au
+    // prochain beacon, réveil périodique pour le repli ADR quand plus aucun
+    // capteur n'est entendu
+    static LoraRxPacket packet;
     for (;;) {
-        if (Serial1.available()) {
-            String line = Serial1.readStringUntil('\n');
-            line.trim();
-            if (line.length() > 0) {
-                processRxLine(line);
-            }
+        uint32_t timeoutMs = 10000;
+#if LORA_BEACON_PERIOD_SEC > 0
+        int32_t untilBeacon = (int32_t)(nextBeaconMs - millis());
+        if (untilBeacon <= 0) {
+            sendBeacon();
+            nextBeaconMs += LORA_BEACON_PERIOD_SEC * 1000UL;
+            // En retard d'une supertrame entière: on repart de maintenant
+            if ((int32_t)(nextBeaconMs - millis()) <= 0) nextBeaconMs = millis() + LORA_BEACON_PERIOD_SEC * 1000UL;
+            continue;
+        }
+        if ((uint32_t)untilBeacon < timeoutMs) timeoutMs = untilBeacon;
+#endif
+        if (loraModem.receive(&packet, timeoutMs)) {
+            processPacket(packet);
+        } else if (adrCheckSilence()) {
+            LOG_WARN("ADR: aucun capteur entendu, retour en SF%u.", adrNetworkSf());
+            applyNetworkSf();
         }
-        
-        vTaskDelay(10 / portTICK_PERIOD_MS); 
     }
 }
 
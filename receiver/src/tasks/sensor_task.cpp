@@ -4,11 +4,15 @@
 #include "../config.h"
 #include "../utils/data_manager.h"
 
+#define LOG_MODULE "SensorTask"
+#define LOG_MODULE_LEVEL LOG_LEVEL_SENSOR
+#include "../utils/logger.h"
+
 // Initialisation du capteur DHT
 static DHT dht(SENSOR_DHT_PIN, SENSOR_DHT_TYPE);
 
 void sensorTask(void *pvParameters) {
-    Serial.println("[SensorTask] Initialisation DHT...");
+    LOG_INFO("Initialisation DHT...");
     dht.begin();
     
     // Attente stabilisation capteur
@@ -27,9 +31,7 @@ void sensorTask(void *pvParameters) {
 
         if (isnan(h) || isnan(t)) {
             errorCount++;
-            Serial.print("[SensorTask] Echec lecture DHT (");
-            Serial.print(errorCount);
-            Serial.println(")");
+            LOG_WARN("Echec lecture DHT (%d)", errorCount);
 
             if (errorCount >= MAX_ERRORS) {
                 setDhtStatus(false);
@@ -39,16 +41,12 @@ void sensorTask(void *pvParameters) {
         } else {
             // Lecture réussie -> Reset compteur
             if (errorCount > 0) {
-                 Serial.println("[SensorTask] Capteur DHT rétabli !");
+                 LOG_INFO("Capteur DHT rétabli !");
             }
             errorCount = 0;
             setDhtStatus(true);
             
-            Serial.print("[SensorTask] Local -> Temp: ");
-            Serial.print(t);
-            Serial.print("°C, Hum: ");
-            Serial.print(h);
-            Serial.println("%");
+            LOG_INFO("Local -> Temp: %f°C, Hum: %f%%", t, h);
 
             updateLocalData(t, h);
         }
@@ -1,11 +1,14 @@
 #include "ui_task.h"
 #include <Arduino.h>
 #include <Arduino_FreeRTOS.h>
+#include <RTC.h> // For time
+#include <button_manager.h>
+#include <led_matrix_manager.h>
 #include "../config.h"
-#include "../utils/button_manager.h"
-#include "../utils/led_matrix_manager.h"
 #include "../utils/data_manager.h"
-#include <RTC.h> // For time
+
+#define LOG_MODULE "UI"
+#include "../utils/logger.h"
 
 // Initialize Button Manager with Config Pins
 static ButtonManager buttons(BUTTON_LEFT_PIN, BUTTON_RIGHT_PIN);
@@ -18,7 +21,7 @@ enum ScreenState {
 };
 
 void uiTask(void *pvParameters) {
-    Serial.println("[UITask] Initialisation...");
+    LOG_INFO("Initialisation...");
     
     buttons.begin();
     initLedMatrix();
@@ -37,7 +40,7 @@ void uiTask(void *pvParameters) {
 
         // --- INPUT HANDLING ---
         if (buttons.isLeftPressed()) {
-            Serial.println("[UI] Button LEFT");
+            LOG_INFO("Button LEFT");
             anyInput = true;
             if (currentState == SCREEN_OFF) {
                 currentState = activeScreen; // Wake up
@@ -49,7 +52,7 @@ void uiTask(void *pvParameters) {
                 currentState = activeScreen;
             }
         } else if (buttons.isRightPressed()) {
-            Serial.println("[UI] Button RIGHT");
+            LOG_INFO("Button RIGHT");
             anyInput = true;
             if (currentState == SCREEN_OFF) {
                 currentState = activeScreen; // Wake up
@@ -69,7 +72,7 @@ void uiTask(void *pvParameters) {
         // --- TIMEOUT MANAGEMENT ---
         if (currentState != SCREEN_OFF) {
             if (now - lastInteraction > TIMEOUT) {
-                Serial.println("[UI] Timeout -> Screen OFF");
+                LOG_INFO("Timeout -> Screen OFF");
                 currentState = SCREEN_OFF;
                 clearLedMatrix();
             }
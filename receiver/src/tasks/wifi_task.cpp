@@ -3,15 +3,122 @@
 #include <Arduino_FreeRTOS.h>
 #include <ArduinoMqttClient.h>
 #include <ArduinoJson.h>
+#include <stdio.h>
+#include <security_utils.h>
+#include <hex_codec.h>
 #include "../config.h"
 #include "../utils/data_manager.h"
 #include "../utils/time_manager.h"
-#include "../utils/security_utils.h"
+#include "../utils/node_keys.h"
+
+#define LOG_MODULE "MQTT"
+#define LOG_MODULE_LEVEL LOG_LEVEL_MQTT
+#include "../utils/logger.h"
 
 // ---------------------- MQTT Setup ----------------------
 WiFiClient espClient;
 MqttClient mqttClient(espClient);
 
+// Buffer de publication: JSON signé + champ "hmac" ajouté en fin
+static const size_t MQTT_PAYLOAD_SIZE = 512;
+static const char HMAC_FIELD_PREFIX[] = ",\"hmac\":\"";
+static const size_t HMAC_FIELD_LEN = (sizeof(HMAC_FIELD_PREFIX) - 1) + 64 + 2; // prefix + hex + "}
+static char mqttPayload[MQTT_PAYLOAD_SIZE];
+
+// Sérialise le document une seule fois dans mqttPayload en calculant le HMAC au fil
+// de l'eau, puis remplace le '}' final par ,"hmac":"<hex>"} (même signature qu'avant :
+// HMAC du JSON sans le champ hmac). Toujours la clé partagée: l'adapter vérifie
+// chaque topic avec SHARED_SECRET, les clés par nœud ne servent que sur le lien LoRa.
+static bool publishSigned(const char *topic, const JsonDocument &doc) {
+    HmacContext hmac;
+    hmac_sha256_init(&hmac, &getSharedKey()->hmac);
+    HmacBufferWriter writer(mqttPayload, MQTT_PAYLOAD_SIZE - HMAC_FIELD_LEN, &hmac);
+    serializeJson(doc, writer);
+
+    if (writer.overflowed() || writer.length() < 2) {
+        LOG_ERROR("ERREUR: payload trop grand pour %s", topic);
+        return false;
+    }
+
+    uint8_t hmac_res[32];
+    writer.finish(hmac_res);
+
+    size_t len = writer.length() - 1; // Ecrase le '}' final
+    memcpy(mqttPayload + len, HMAC_FIELD_PREFIX, sizeof(HMAC_FIELD_PREFIX) - 1);
+    len += sizeof(HMAC_FIELD_PREFIX) - 1;
+    len += hex_encode(hmac_res, 32, mqttPayload + len);
+    mqttPayload[len++] = '"';
+    mqttPayload[len++] = '}';
+
+    // Taille connue d'avance: pas de buffer de message alloué par le client MQTT
+    mqttClient.beginMessage(topic, (unsigned long)len, false, 1);
+    mqttClient.write((const uint8_t*)mqttPayload, len);
+    mqttClient.endMessage();
+    return true;
+}
+
+// ---------------------- Noms MQTT par capteur ----------------------
+struct MqttNodeName {
+    uint8_t sensorId;
+    const char *id;
+    const char *topic;
+};
+
+static const MqttNodeName mqttNodeNames[] = MQTT_NODE_NAMES;
+static const size_t MQTT_NODE_NAME_COUNT = sizeof(mqttNodeNames) / sizeof(mqttNodeNames[0]);
+static const char GENERATED_ID_PREFIX[] = "node";
+
+// Identifiant de handshake / champ "source" (id) et topic de publication d'un capteur
+static void mqttNames(uint8_t sensorId, char *id, size_t idCap, char *topic, size_t topicCap) {
+    for (size_t i = 0; i < MQTT_NODE_NAME_COUNT; i++) {
+        if (mqttNodeNames[i].sensorId == sensorId) {
+            snprintf(id, idCap, "%s", mqttNodeNames[i].id);
+            snprintf(topic, topicCap, "%s", mqttNodeNames[i].topic);
+            return;
+        }
+    }
+    snprintf(id, idCap, "%s%u", GENERATED_ID_PREFIX, sensorId);
+    snprintf(topic, topicCap, "%s%u", MQTT_TOPIC_NODE_PREFIX, sensorId);
+}
+
+// Inverse de mqttNames() pour les réponses de handshake
+static bool sensorIdFromMqttId(const char *id, uint8_t *sensorId) {
+    for (size_t i = 0; i < MQTT_NODE_NAME_COUNT; i++) {
+        if (strcmp(mqttNodeNames[i].id, id) == 0) {
+            *sensorId = mqttNodeNames[i].sensorId;
+            return true;
+        }
+    }
+    size_t prefixLen = sizeof(GENERATED_ID_PREFIX) - 1;
+    if (strncmp(id, GENERATED_ID_PREFIX, prefixLen) != 0 || id[prefixLen] == '\0') return false;
+    char *end;
+    unsigned long value = strtoul(id + prefixLen, &end, 10);
+    if (*end != '\0' || value > 0xFF) return false;
+    *sensorId = (uint8_t)value;
+    return true;
+}
+
+static void requestHandshake(uint8_t sensorId) {
+    char id[16], topic[48];
+    mqttNames(sensorId, id, sizeof(id), topic, sizeof(topic));
+    mqttClient.beginMessage(MQTT_TOPIC_HANDSHAKE_REQ);
+    mqttClient.print("{\"id\":\"");
+    mqttClient.print(id);
+    mqttClient.print("\"}");
+    mqttClient.endMessage();
+}
+
+// Capteur local + chaque capteur distant connu sans handshake
+static void requestMissingHandshakes() {
+    if (!isMqttHandshakeDone(CAFETERIA_ID)) requestHandshake(CAFETERIA_ID);
+
+    uint8_t ids[MAX_REMOTE_NODES];
+    size_t count = getRemoteNodeIds(ids, MAX_REMOTE_NODES);
+    for (size_t i = 0; i < count; i++) {
+        if (ids[i] != CAFETERIA_ID && !isMqttHandshakeDone(ids[i])) requestHandshake(ids[i]);
+    }
+}
+
 // Callback pour les messages MQTT (Handshake)
 void onMqttMessage(int messageSize) {
     String topic = mqttClient.messageTopic();
@@ -25,49 +132,91 @@ void onMqttMessage(int messageSize) {
         StaticJsonDocument<128> doc;
         DeserializationError error = deserializeJson(doc, payload);
         
-        if (!error && doc.containsKey("seq") && doc.containsKey("id")) {
+        uint8_t sensorId;
+        if (!error && doc.containsKey("seq") && doc.containsKey("id") && sensorIdFromMqttId(doc["id"], &sensorId)) {
             const char* id = doc["id"];
             uint32_t seq = doc["seq"];
-            Serial.print("[MQTT] Handshake réussi pour ");
-            Serial.print(id);
-            Serial.print(" ! Séquence : ");
-            Serial.println(seq);
-            setMqttSequence(id, seq);
+            LOG_INFO("Handshake réussi pour %s ! Séquence : %lu", id, seq);
+            setMqttSequence(sensorId, seq);
         }
     }
 }
 
+// Pourcentage du temps sur l'heure glissante, "0.12" (chaîne comme les mesures)
+static const char *dutyCycleStr(uint32_t hourUs, char *buf, size_t cap) {
+    uint16_t cp = airtime_duty_cycle_cp(hourUs);
+    snprintf(buf, cap, "%u.%02u", cp / 100, cp % 100);
+    return buf;
+}
+
+// Publie l'état d'un capteur distant (nouvelle trame ou changement stale/online)
+static void publishRemoteNode(const RemoteSensorData &node, bool isStale, bool loraConnected) {
+    char id[16], topic[48];
+    mqttNames(node.nodeId, id, sizeof(id), topic, sizeof(topic));
+
+    uint32_t seq = getNextMqttSequence(node.nodeId);
+    StaticJsonDocument<512> doc;
+    char humStr[12], tempStr[12], dutyStr[12];
+    uint32_t airtimeUs = airtime_window_us(&node.airtime, millis());
+
+    // Clés en ordre alphabétique (signature vérifiée sur le JSON trié par l'adapter)
+    bool remoteDhtOk = node.temperature != SENSOR_VALUE_NAN;
+    doc["airtimeMs"] = airtimeUs / 1000;
+    if (node.batteryMv != 0) doc["batteryMv"] = node.batteryMv;
+    if (node.capturedAt != 0) doc["capturedAt"] = node.capturedAt;
+    doc["dhtStatus"] = remoteDhtOk;
+    doc["dutyCycle"] = dutyCycleStr(airtimeUs, dutyStr, sizeof(dutyStr));
+    doc["humidity"] = remoteDhtOk ? (const char*)dtostrf(centiToFloat(node.humidity), 1, 1, humStr) : "N/A";
+    doc["loraStatus"] = isStale ? false : loraConnected;
+    if (node.hasStatus) doc["nodeStatus"] = node.status;
+    doc["packetsLost"] = node.packetsLost;
+    doc["packetsReceived"] = node.packetsReceived;
+    doc["rssi"] = node.rssi;
+    doc["seq"] = seq;
+    doc["snr"] = (int)node.snr;
+    doc["source"] = (const char*)id;
+    doc["temperature"] = remoteDhtOk ? (const char*)dtostrf(centiToFloat(node.temperature), 1, 1, tempStr) : "N/A";
+
+    publishSigned(topic, doc);
+    setRemotePublished(node.nodeId, node.packetsReceived, isStale);
+    LOG_INFO("Update %s (LoRa) envoyé.", id);
+}
+
 // ---------------------- Task ----------------------
 void wifiTask(void *pvParameters) {
     // Identification du client
     mqttClient.setId("ArduinoPasserelle");
     mqttClient.onMessage(onMqttMessage);
 
+    // Capteurs nommés: connus dès le départ (handshake + publication "hors ligne"
+    // avant leur première trame)
+    for (size_t i = 0; i < MQTT_NODE_NAME_COUNT; i++) {
+        if (mqttNodeNames[i].sensorId != CAFETERIA_ID) registerRemoteNode(mqttNodeNames[i].sensorId);
+    }
+
     for (;;) {
         // --- 1. GESTION WIFI ---
         // (Code de connexion WiFi inchangé...)
         if (WiFi.status() != WL_CONNECTED) {
             setWifiStatus(false);
             setMqttStatus(false);
-            setMqttHandshakeDone("cafeteria", false); 
-            setMqttHandshakeDone("fablab", false); // Reset handshake si on perd la connexion
+            resetMqttHandshakes(); // Reset handshake si on perd la connexion
             
-            Serial.println("[WiFi] Connexion perdue ou non établie. Tentative...");
+            LOG_WARN("WiFi: connexion perdue ou non établie. Tentative...");
             WiFi.begin(WIFI_SSID, WIFI_PASS);
             
             int tryCount = 0;
             while (WiFi.status() != WL_CONNECTED && tryCount < 20) {
                 vTaskDelay(500 / portTICK_PERIOD_MS);
-                Serial.print(".");
                 tryCount++;
             }
             
             if (WiFi.status() == WL_CONNECTED) {
-                Serial.println("\n[WiFi] Connecté ! IP: " + WiFi.localIP().toString());
+                LOG_INFO("WiFi connecté ! IP: %s", WiFi.localIP().toString());
                 setWifiStatus(true);
                 if (syncTimeWithNTP()) setTimeSyncStatus(true);
             } else {
-                 Serial.println("\n[WiFi] Échec. Prochaine tentative dans 5s...");
+                 LOG_ERROR("WiFi: échec. Prochaine tentative dans 5s...");
                  vTaskDelay(5000 / portTICK_PERIOD_MS);
                  continue;
             }
@@ -79,30 +228,21 @@ void wifiTask(void *pvParameters) {
         if (WiFi.status() == WL_CONNECTED) {
             if (!mqttClient.connected()) {
                 setMqttStatus(false);
-                setMqttHandshakeDone("cafeteria", false);
-                setMqttHandshakeDone("fablab", false);
-                Serial.println("[MQTT] Connexion au broker...");
+                resetMqttHandshakes();
+                LOG_INFO("Connexion au broker...");
                 
                 if (mqttClient.connect(MQTT_SERVER, MQTT_PORT)) {
-                    Serial.println("[MQTT] Connecté !");
+                    LOG_INFO("Connecté !");
                     setMqttStatus(true);
                     
-                    // Souscription aux topics de handshake (Wildcard pour les deux)
+                    // Souscription aux topics de handshake (Wildcard pour tous les capteurs)
                     mqttClient.subscribe("cesi/handshake/res/#");
                     
-                    // Demandes initiales
-                    mqttClient.beginMessage(MQTT_TOPIC_HANDSHAKE_REQ);
-                    mqttClient.print("{\"id\":\"cafeteria\"}");
-                    mqttClient.endMessage();
-                    
-                    mqttClient.beginMessage(MQTT_TOPIC_HANDSHAKE_REQ);
-                    mqttClient.print("{\"id\":\"fablab\"}");
-                    mqttClient.endMessage();
-                    
-                    Serial.println("[MQTT] Handshakes demandés (Cafet & Fablab)...");
+                    // Demandes initiales: capteur local + capteurs distants déjà entendus
+                    requestMissingHandshakes();
+                    LOG_INFO("Handshakes demandés...");
                 } else {
-                    Serial.print("[MQTT] Échec, code=");
-                    Serial.println(mqttClient.connectError());
+                    LOG_ERROR("Échec, code=%d", mqttClient.connectError());
                     vTaskDelay(5000 / portTICK_PERIOD_MS);
                 }
             }
@@ -115,23 +255,12 @@ void wifiTask(void *pvParameters) {
                 static unsigned long lastHandshakeRetry = 0;
                 if (millis() - lastHandshakeRetry > 10000) {
                     lastHandshakeRetry = millis();
-                    if (!isMqttHandshakeDone("cafeteria")) {
-                        mqttClient.beginMessage(MQTT_TOPIC_HANDSHAKE_REQ);
-                        mqttClient.print("{\"id\":\"cafeteria\"}");
-                        mqttClient.endMessage();
-                    }
-                    if (!isMqttHandshakeDone("fablab")) {
-                        mqttClient.beginMessage(MQTT_TOPIC_HANDSHAKE_REQ);
-                        mqttClient.print("{\"id\":\"fablab\"}");
-                        mqttClient.endMessage();
-                    }
+                    requestMissingHandshakes();
                 }
 
                 // --- 2. LOGIQUE DE PUBLICATION ---
-                static uint32_t lastPublishedPacketsFablab = 0;
                 static float lastPublishedTempCafet = -100.0;
                 static unsigned long lastCafetPubTime = 0;
-                static bool fablabWasStale = false;
 
                 SystemData data = getSystemData();
                 unsigned long now = millis();
@@ -139,86 +268,63 @@ void wifiTask(void *pvParameters) {
                 const unsigned long CAFET_PUB_INTERVAL = 30000; // 30s pour le local
 
                 // --- 2.1 Publication Locale (Cafeteria) ---
-                if (isMqttHandshakeDone("cafeteria")) {
+                if (isMqttHandshakeDone(CAFETERIA_ID)) {
                     // On publie si: > 30s écoulées OU changement temp > 0.2°C (ou passage à NAN)
                     bool timeToPub = (now - lastCafetPubTime > CAFET_PUB_INTERVAL);
                     bool tempChanged = isnan(data.localTemperature) != isnan(lastPublishedTempCafet) || 
                                      (abs(data.localTemperature - lastPublishedTempCafet) > 0.2);
 
                     if (timeToPub || tempChanged) {
-                        uint32_t seq = getNextMqttSequence("cafeteria");
+                        uint32_t seq = getNextMqttSequence(CAFETERIA_ID);
                         StaticJsonDocument<512> doc;
+                        char humStr[12], tempStr[12], dutyStr[12];
+                        const GatewayRadioStats &radio = data.radio;
+                        uint32_t txUs = airtime_window_us(&radio.txAirtime, now);
                         
                         doc["dhtStatus"] = data.dhtModuleConnected;
-                        doc["humidity"] = isnan(data.localHumidity) ? "N/A" : String(data.localHumidity, 1);
+                        doc["humidity"] = isnan(data.localHumidity) ? "N/A" : (const char*)dtostrf(data.localHumidity, 1, 1, humStr);
                         doc["loraStatus"] = data.loraModuleConnected;
+                        // Passerelle sourde pendant ses émissions (max d'une fenêtre, total sur l'heure)
+                        doc["rxBlindMaxMs"] = radio.rxBlindMaxUs / 1000;
+                        doc["rxBlindMs"] = airtime_window_us(&radio.rxBlind, now) / 1000;
                         doc["seq"] = seq;
                         doc["source"] = "cafeteria";
-                        doc["temperature"] = isnan(data.localTemperature) ? "N/A" : String(data.localTemperature, 1);
-                        
-                        String payload;
-                        serializeJson(doc, payload);
-                        uint8_t hmac_res[32];
-                        hmac_sha256((const uint8_t*)LORA_SHARED_SECRET, strlen(LORA_SHARED_SECRET), 
-                                    (const uint8_t*)payload.c_str(), payload.length(), hmac_res);
-                        doc["hmac"] = hashToString(hmac_res);
-                        payload = "";
-                        serializeJson(doc, payload);
+                        doc["temperature"] = isnan(data.localTemperature) ? "N/A" : (const char*)dtostrf(data.localTemperature, 1, 1, tempStr);
+                        doc["txAirtimeMs"] = txUs / 1000;
+                        doc["txDutyCycle"] = dutyCycleStr(txUs, dutyStr, sizeof(dutyStr));
+                        doc["txRefused"] = radio.txRefused;
                         
-                        mqttClient.beginMessage(MQTT_TOPIC_CAFET, false, 1);
-                        mqttClient.print(payload);
-                        mqttClient.endMessage();
+                        publishSigned(MQTT_TOPIC_CAFET, doc);
 
                         lastCafetPubTime = now;
                         lastPublishedTempCafet = data.localTemperature;
-                        Serial.println("[MQTT] Update Cafet (Local) envoyé.");
+                        LOG_INFO("Update Cafet (Local) envoyé.");
                     }
                 }
 
-                // --- 2.2 Publication Distante (Fablab) ---
-                bool fablabIsStale = (now - data.fablab.lastUpdate > LORA_TIMEOUT);
-
-                if (isMqttHandshakeDone("fablab")) {
-                    // On publie si: Nouveau paquet LoRa reçu OU changement d'état stale (Offline)
-                    if (data.fablab.packetsReceived > lastPublishedPacketsFablab || fablabIsStale != fablabWasStale) {
-                        
-                        uint32_t seq = getNextMqttSequence("fablab");
-                        StaticJsonDocument<512> doc;
-                        
-                        bool remoteDhtOk = !isnan(data.fablab.temperature);
-                        doc["dhtStatus"] = remoteDhtOk;
-                        doc["humidity"] = remoteDhtOk ? String(data.fablab.humidity, 1) : "N/A";
-                        doc["loraStatus"] = fablabIsStale ? false : data.loraModuleConnected;
-                        doc["packetsLost"] = data.fablab.packetsLost;
-                        doc["packetsReceived"] = data.fablab.packetsReceived;
-                        doc["rssi"] = data.fablab.rssi;
-                        doc["seq"] = seq;
-                        doc["snr"] = data.fablab.snr;
-                        doc["source"] = "fablab";
-                        doc["temperature"] = remoteDhtOk ? String(data.fablab.temperature, 1) : "N/A";
-                        
-                        String payload;
-                        serializeJson(doc, payload);
-                        uint8_t hmac_res[32];
-                        hmac_sha256((const uint8_t*)LORA_SHARED_SECRET, strlen(LORA_SHARED_SECRET), 
-                                    (const uint8_t*)payload.c_str(), payload.length(), hmac_res);
-                        doc["hmac"] = hashToString(hmac_res);
-                        payload = "";
-                        serializeJson(doc, payload);
-                        
-                        mqttClient.beginMessage(MQTT_TOPIC_FABLAB, false, 1);
-                        mqttClient.print(payload);
-                        mqttClient.endMessage();
-
-                        lastPublishedPacketsFablab = data.fablab.packetsReceived;
-                        fablabWasStale = fablabIsStale;
-                        Serial.println("[MQTT] Update Fablab (LoRa) envoyé.");
+                // --- 2.2 Publication Distante (un topic par capteur) ---
+                // On publie si: Nouveau paquet LoRa reçu OU changement d'état stale (Offline)
+                uint8_t ids[MAX_REMOTE_NODES];
+                size_t nodeCount = getRemoteNodeIds(ids, MAX_REMOTE_NODES);
+                bool waitingHandshake = false;
+                for (size_t i = 0; i < nodeCount; i++) {
+                    RemoteSensorData node;
+                    if (ids[i] == CAFETERIA_ID || !getRemoteNode(ids[i], &node)) continue;
+                    if (!node.mqttHandshakeDone) {
+                        waitingHandshake = true;
+                        continue;
                     }
-                } else {
+                    bool isStale = (now - node.lastUpdate > LORA_TIMEOUT);
+                    if (node.packetsReceived > node.mqttPublishedPackets || isStale != node.mqttWasStale) {
+                        publishRemoteNode(node, isStale, data.loraModuleConnected);
+                    }
+                }
+
+                if (waitingHandshake) {
                     // Petit log de debug pour voir si le handshake bloque
                     static unsigned long lastHandshakeLog = 0;
                     if (now - lastHandshakeLog > 15000) {
-                        Serial.println("[MQTT] En attente du Handshake Fablab...");
+                        LOG_INFO("En attente de handshake(s) capteur...");
                         lastHandshakeLog = now;
                     }
                 }
@@ -0,0 +1,53 @@
+#include "ack_tracker.h"
+
+// Bit 0 of `above` is always clear once normalized. Frames further ahead than
+// the window resynchronize it.
+#define ACK_WINDOW (LORA_ACK_MAP_BITS + 1)
+
+SeqStatus seq_window_accept(SeqWindow *w, uint8_t sequence) {
+    if (!w->valid) {
+        w->valid = true;
+        w->cum = w->newest = sequence;
+        w->above = 0;
+        return SEQ_NEW;
+    }
+
+    uint8_t d = (uint8_t)(sequence - w->cum);
+    if (d == 0 || d >= 128) return SEQ_DUPLICATE;   // At or behind CUM
+    if (d > ACK_WINDOW) {
+        // Too far ahead (long outage or sender restart): start over from here
+        w->cum = w->newest = sequence;
+        w->above = 0;
+        return SEQ_NEW;
+    }
+
+    uint32_t bit = 1UL << (d - 1);
+    if (w->above & bit) return SEQ_DUPLICATE;
+    SeqStatus status = ((uint8_t)(w->newest - w->cum) > d) ? SEQ_RECOVERED : SEQ_NEW;
+    if (status == SEQ_NEW) w->newest = sequence;
+
+    w->above |= bit;
+    while (w->above & 1) {
+        w->cum++;
+        w->above >>= 1;
+    }
+    return status;
+}
+
+SeqStatus seq_window_peek(const SeqWindow *w, uint8_t sequence) {
+    if (!w->valid) return SEQ_NEW;
+    uint8_t d = (uint8_t)(sequence - w->cum);
+    if (d == 0 || d >= 128) return SEQ_DUPLICATE;
+    if (d > ACK_WINDOW) return SEQ_NEW;
+    if (w->above & (1UL << (d - 1))) return SEQ_DUPLICATE;
+    return ((uint8_t)(w->newest - w->cum) > d) ? SEQ_RECOVERED : SEQ_NEW;
+}
+
+bool seq_window_recent(const SeqWindow *w, uint8_t sequence) {
+    return w->valid && (uint8_t)(w->newest - sequence) < ACK_WINDOW;
+}
+
+void seq_window_state(const SeqWindow *w, uint8_t *cum, uint16_t *map) {
+    *cum = w->valid ? w->cum : 0;
+    *map = w->valid ? (uint16_t)(w->above >> 1) : 0;
+}
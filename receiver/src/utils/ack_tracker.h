@@ -0,0 +1,39 @@
+#ifndef ACK_TRACKER_H
+#define ACK_TRACKER_H
+
+#include <Arduino.h>
+#include <lora_protocol.h>
+
+// Receive window behind the cumulative ACK: the highest contiguous sequence
+// and which of the next ones already arrived. Also tells duplicates
+// (retransmissions of a frame we have) apart from new frames. One window per
+// node, stored in the data manager's node table.
+
+enum SeqStatus : uint8_t {
+    SEQ_NEW = 0,        // In order or filling a gap ahead of CUM
+    SEQ_RECOVERED,      // A gap behind the newest frame, filled by a retransmission
+    SEQ_DUPLICATE       // Already received
+};
+
+struct SeqWindow {
+    uint8_t cum;
+    uint8_t newest;     // Highest sequence seen (cum + window at most)
+    bool valid;         // False until the first frame
+    uint32_t above;     // Bit k = sequence cum + 1 + k received
+};
+
+// Records a sequence in the window
+SeqStatus seq_window_accept(SeqWindow *w, uint8_t sequence);
+
+// What seq_window_accept would return, without recording anything
+SeqStatus seq_window_peek(const SeqWindow *w, uint8_t sequence);
+
+// True if sequence is at most ACK_WINDOW behind the newest frame: a sender only
+// retransmits frames that recent, so a duplicate there is a late retransmission
+// and not a restarted sender
+bool seq_window_recent(const SeqWindow *w, uint8_t sequence);
+
+// CUM / MAP of the window, as sent in a cumulative ACK
+void seq_window_state(const SeqWindow *w, uint8_t *cum, uint16_t *map);
+
+#endif
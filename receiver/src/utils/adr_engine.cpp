@@ -0,0 +1,117 @@
+#include "adr_engine.h"
+#include "../config.h"
+
+#define ADR_HISTORY 4
+#define ADR_MAX_NODES MAX_REMOTE_NODES
+
+struct AdrNode {
+    uint8_t nodeId;
+    bool used;
+    uint8_t adr;          // Settings of the frames in the history
+    uint8_t wantedSf;     // SF this node alone would use
+    uint8_t snrCount;
+    uint8_t snrPos;
+    int8_t snr[ADR_HISTORY];
+    uint32_t lastSeen;
+};
+
+// Demodulation floor per SF (SX126x datasheet), in tenths of dB: SF7 .. SF12
+static const int16_t REQUIRED_SNR_X10[LORA_MAX_SF - LORA_MIN_SF + 1] = { -75, -100, -125, -150, -175, -200 };
+
+static AdrNode nodes[ADR_MAX_NODES];
+static uint8_t networkSf = LORA_DEFAULT_SF;
+static uint32_t lastUplink = 0;
+
+static AdrNode *findNode(uint8_t nodeId) {
+    AdrNode *oldest = &nodes[0];
+    for (size_t i = 0; i < ADR_MAX_NODES; i++) {
+        if (nodes[i].used && nodes[i].nodeId == nodeId) return &nodes[i];
+    }
+    // New node: free slot, else the one heard the longest ago
+    for (size_t i = 0; i < ADR_MAX_NODES; i++) {
+        if (!nodes[i].used) { oldest = &nodes[i]; break; }
+        if (millis() - nodes[i].lastSeen > millis() - oldest->lastSeen) oldest = &nodes[i];
+    }
+    memset(oldest, 0, sizeof(*oldest));
+    oldest->used = true;
+    oldest->nodeId = nodeId;
+    return oldest;
+}
+
+// Margin above the floor + LORA_ADR_MARGIN_DB, in 3 dB steps (floor division)
+static int marginSteps(int snr, uint8_t sf) {
+    int marginX10 = snr * 10 - REQUIRED_SNR_X10[sf - LORA_MIN_SF] - LORA_ADR_MARGIN_DB * 10;
+    return (marginX10 >= 0) ? marginX10 / 30 : -((-marginX10 + 29) / 30);
+}
+
+static void updateNetworkSf() {
+#if LORA_ADR_ADAPT_SF
+    uint8_t sf = LORA_MIN_SF;
+    for (size_t i = 0; i < ADR_MAX_NODES; i++) {
+        if (nodes[i].used && millis() - nodes[i].lastSeen < LORA_ADR_SILENCE_MS && nodes[i].wantedSf > sf) {
+            sf = nodes[i].wantedSf;
+        }
+    }
+    networkSf = sf;
+#else
+    networkSf = LORA_DEFAULT_SF;
+#endif
+}
+
+uint8_t adrOnUplink(uint8_t nodeId, uint8_t nodeAdr, int snr) {
+    AdrNode *node = findNode(nodeId);
+    node->lastSeen = millis();
+    lastUplink = node->lastSeen;
+
+    // Nodes without ADR send at the network SF, full power
+    if (!loraAdrValid(nodeAdr)) nodeAdr = loraAdrMake(networkSf, 0);
+
+    // SNR measured with other settings says nothing about the current ones
+    if (node->adr != nodeAdr) {
+        node->adr = nodeAdr;
+        node->snrCount = 0;
+        node->snrPos = 0;
+    }
+    node->snr[node->snrPos] = (int8_t)constrain(snr, -128, 127);
+    node->snrPos = (node->snrPos + 1) % ADR_HISTORY;
+    if (node->snrCount < ADR_HISTORY) node->snrCount++;
+
+    uint8_t sf = loraAdrSf(nodeAdr);
+    uint8_t step = loraAdrPowerStep(nodeAdr);
+
+    int steps = marginSteps(snr, sf);
+    if (steps >= 0) {
+        if (node->snrCount < ADR_HISTORY) {
+            steps = 0;
+        } else {
+            int best = node->snr[0];
+            for (uint8_t i = 1; i < ADR_HISTORY; i++) best = max(best, (int)node->snr[i]);
+            steps = marginSteps(best, sf);
+        }
+    }
+
+    while (steps > 0 && sf > LORA_MIN_SF) { sf--; steps--; }
+    while (steps > 0 && step < LORA_POWER_STEPS - 1) { step++; steps--; }
+    while (steps < 0 && step > 0) { step--; steps++; }
+    while (steps < 0 && sf < LORA_MAX_SF) { sf++; steps++; }
+
+    node->wantedSf = sf;
+    updateNetworkSf();
+
+    // Each SF above what the node needs is ~2.5 dB of link budget: one power step
+    for (uint8_t extra = networkSf > sf ? networkSf - sf : 0; extra > 0 && step < LORA_POWER_STEPS - 1; extra--) {
+        step++;
+    }
+    return loraAdrMake(networkSf, step);
+}
+
+uint8_t adrNetworkSf() {
+    return networkSf;
+}
+
+bool adrCheckSilence() {
+    if (networkSf == LORA_DEFAULT_SF || millis() - lastUplink < LORA_ADR_SILENCE_MS) return false;
+    for (size_t i = 0; i < ADR_MAX_NODES; i++) nodes[i].used = false;
+    networkSf = LORA_DEFAULT_SF;
+    return true;
+}
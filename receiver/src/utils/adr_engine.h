@@ -0,0 +1,32 @@
+#ifndef ADR_ENGINE_H
+#define ADR_ENGINE_H
+
+#include <Arduino.h>
+#include <lora_protocol.h>
+
+// Gateway-side adaptive data rate. Per node, the SNR of the last frames is
+// compared with the demodulation floor of the SF they were sent at; the
+// margin above LORA_ADR_MARGIN_DB is spent in 3 dB steps (lower SF first,
+// then lower TX power), a negative margin buys power back first, then SF.
+// Lowering needs a full history (its best SNR), raising reacts to the last
+// frame alone.
+//
+// The Wio-E5 demodulates a single SF at a time, so the SF is network-wide:
+// the highest SF wanted by the nodes heard within LORA_ADR_SILENCE_MS. Only
+// the TX power is per node (a node below the network SF gets the difference
+// back as power steps).
+//
+// Called from the LoRa task only: no locking.
+
+// Records a DATA frame (nodeAdr = ADR byte the node sent, LORA_ADR_NONE if
+// none) and returns the ADR byte to put in its ACK
+uint8_t adrOnUplink(uint8_t nodeId, uint8_t nodeAdr, int snr);
+
+// SF the gateway must listen on
+uint8_t adrNetworkSf();
+
+// Back to LORA_DEFAULT_SF when nothing was heard for LORA_ADR_SILENCE_MS (the
+// nodes fall back on their side after lost ACKs). True if the SF changed.
+bool adrCheckSilence();
+
+#endif
@@ -0,0 +1,93 @@
+#include "crypto_bench.h"
+#include <Arduino.h>
+#include <sha256.h>
+#include <security_utils.h>
+#include "../config.h"
+#include "node_keys.h"
+
+static const int BENCH_ITERATIONS = 100;
+
+static void startCycleCounter() {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static void printResult(const char *label, uint32_t cycles) {
+    Serial.print("[Bench] ");
+    Serial.print(label);
+    Serial.print(" : ");
+    Serial.print(cycles / BENCH_ITERATIONS);
+    Serial.println(" cycles/verify");
+}
+
+// SHA-256 cost per byte for the message sizes seen in the firmware
+// (7-byte LoRa frame, one block, a full MQTT payload)
+static void benchSha256() {
+    static uint8_t msg[512];
+    for (size_t i = 0; i < sizeof(msg); i++) msg[i] = (uint8_t)i;
+    const size_t sizes[] = { 7, 64, 512 };
+    uint8_t out[32];
+
+    Serial.println("--- Crypto Benchmark (SHA-256) ---");
+    for (size_t s = 0; s < 3; s++) {
+        uint32_t t0 = DWT->CYCCNT;
+        for (int i = 0; i < BENCH_ITERATIONS; i++) {
+            SHA256_CTX ctx;
+            sha256_init(&ctx); sha256_update(&ctx, msg, sizes[s]); sha256_final(&ctx, out);
+        }
+        uint32_t cycles = (DWT->CYCCNT - t0) / BENCH_ITERATIONS;
+        Serial.print("[Bench] sha256 ");
+        Serial.print(sizes[s]);
+        Serial.print(" B : ");
+        Serial.print(cycles);
+        Serial.print(" cycles (");
+        Serial.print((float)cycles / sizes[s], 1);
+        Serial.println(" cycles/B)");
+    }
+}
+
+void runCryptoBenchmark() {
+    // Same shape as a type 2 frame: [ID, Type, Seq, T_low, T_high, H_low, H_high]
+    uint8_t frame[7] = { FABLAB_ID, 2, 42, 0x34, 0x08, 0x88, 0x13 };
+    uint8_t receivedHash[32];
+    uint8_t calculatedHash[32];
+    hmac_sha256((const uint8_t*)LORA_SHARED_SECRET, strlen(LORA_SHARED_SECRET), frame, 7, receivedHash);
+
+    startCycleCounter();
+    volatile int matches = 0;
+
+    // 1. Legacy path: ipad/opad rebuilt from the secret on every frame
+    uint32_t t0 = DWT->CYCCNT;
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        hmac_sha256((const uint8_t*)LORA_SHARED_SECRET, strlen(LORA_SHARED_SECRET), frame, 7, calculatedHash);
+        matches += (memcmp(receivedHash, calculatedHash, 32) == 0);
+    }
+    uint32_t legacyCycles = DWT->CYCCNT - t0;
+
+    // 2. Keyed path: node lookup + cached midstates
+    t0 = DWT->CYCCNT;
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        hmac_sha256_with_key(&getNodeKey(frame[0])->hmac, frame, 7, calculatedHash);
+        matches += (memcmp(receivedHash, calculatedHash, 32) == 0);
+    }
+    uint32_t keyedCycles = DWT->CYCCNT - t0;
+
+    // 3. SipHash-2-4 engine (protocol v2), 8-byte tag
+    uint8_t sipTag[SIPHASH_OUTPUT_LEN];
+    mac_compute(MAC_SIPHASH_2_4, getNodeKey(frame[0]), frame, 7, sipTag);
+    t0 = DWT->CYCCNT;
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        mac_compute(MAC_SIPHASH_2_4, getNodeKey(frame[0]), frame, 7, calculatedHash);
+        matches += constant_time_equal(sipTag, calculatedHash, SIPHASH_OUTPUT_LEN);
+    }
+    uint32_t sipCycles = DWT->CYCCNT - t0;
+
+    Serial.println("--- Crypto Benchmark (RX verify, 7-byte frame) ---");
+    printResult("hmac_sha256 (secret)  ", legacyCycles);
+    printResult("hmac_sha256_with_key  ", keyedCycles);
+    printResult("siphash-2-4 (v2)      ", sipCycles);
+    if (matches != 3 * BENCH_ITERATIONS) Serial.println("[Bench] ERREUR: resultats MAC differents !");
+
+    benchSha256();
+}
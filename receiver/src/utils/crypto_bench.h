@@ -0,0 +1,8 @@
+#ifndef CRYPTO_BENCH_H
+#define CRYPTO_BENCH_H
+
+// Measures the cost of the RX path HMAC verification with the DWT cycle counter
+// and prints the results on Serial. Call from setup() (CRYPTO_BENCHMARK in config.h).
+void runCryptoBenchmark();
+
+#endif
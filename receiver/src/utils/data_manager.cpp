@@ -2,15 +2,59 @@
 #include <Arduino_FreeRTOS.h>
 #include "../config.h"
 
+#define LOG_MODULE "DataManager"
+#include "logger.h"
+
+#if (MAX_REMOTE_NODES & (MAX_REMOTE_NODES - 1)) != 0
+#error "MAX_REMOTE_NODES must be a power of two"
+#endif
+
 static SystemData currentState;
 static SemaphoreHandle_t dataMutex;
 
+// Capteurs distants: adressage ouvert, sondage linéaire. Pas de suppression (un
+// capteur reste connu), donc pas de pierres tombales.
+static RemoteSensorData nodes[MAX_REMOTE_NODES];
+static size_t nodeCount = 0;
+
+// Hachage de Fibonacci: des IDs consécutifs tombent loin les uns des autres
+static inline size_t nodeSlot(uint8_t sensorId) {
+    return ((uint32_t)sensorId * 2654435769u >> 24) & (MAX_REMOTE_NODES - 1);
+}
+
+// Appelé mutex pris. create = ajoute le capteur s'il est inconnu (NULL si la table est pleine)
+static RemoteSensorData *findNode(uint8_t sensorId, bool create) {
+    size_t slot = nodeSlot(sensorId);
+    for (size_t probe = 0; probe < MAX_REMOTE_NODES; probe++) {
+        RemoteSensorData &node = nodes[(slot + probe) & (MAX_REMOTE_NODES - 1)];
+        if (node.used && node.nodeId == sensorId) return &node;
+        if (!node.used) {
+            if (!create) return NULL;
+            memset(&node, 0, sizeof(node));
+            node.used = true;
+            node.nodeId = sensorId;
+            node.temperature = SENSOR_VALUE_NAN;
+            node.humidity = SENSOR_VALUE_NAN;
+            nodeCount++;
+            LOG_INFO("Nouveau capteur %u (%u/%u)", sensorId, nodeCount, MAX_REMOTE_NODES);
+            return &node;
+        }
+    }
+    return NULL;
+}
+
+static int16_t toCenti(float value) {
+    return isnan(value) ? SENSOR_VALUE_NAN : (int16_t)lroundf(value * 100);
+}
+
 void initDataManager() {
     dataMutex = xSemaphoreCreateBinary();
     if (dataMutex != NULL) {
         xSemaphoreGive(dataMutex);
     }
     memset(&currentState, 0, sizeof(SystemData));
+    memset(nodes, 0, sizeof(nodes));
+    nodeCount = 0;
     currentState.loraModuleConnected = false;
     currentState.dhtModuleConnected = false;
     currentState.wifiConnected = false;
@@ -26,14 +70,16 @@ void updateLocalData(float temp, float hum) {
     }
 }
 
-static void updateRemoteSensor(RemoteSensorData &sensor, float temp, float hum, int rssi, int snr, uint8_t sequence) {
-    sensor.temperature = temp;
-    sensor.humidity = hum;
+static void updateRemoteSensor(RemoteSensorData &sensor, float temp, float hum, int rssi, int snr, uint8_t sequence,
+                               uint32_t capturedAt) {
+    sensor.temperature = toCenti(temp);
+    sensor.humidity = toCenti(hum);
     sensor.lastUpdate = millis();
+    sensor.capturedAt = capturedAt;
     
     // N'utiliser le RSSI/SNR que s'ils sont fournis (non nuls)
     if (rssi != 0) sensor.rssi = rssi;
-    if (snr != 0) sensor.snr = snr;
+    if (snr != 0) sensor.snr = (int8_t)constrain(snr, -128, 127);
     
     // Detection de perte de paquets
     if (sensor.packetsReceived > 0) {
@@ -53,7 +99,7 @@ static void updateRemoteSensor(RemoteSensorData &sensor, float temp, float hum,
             if (gap < 100) {
                 sensor.packetsLost += gap;
             } else {
-                Serial.println("[DataManager] Reset du Sender detecte (Saut de sequence ignore)");
+                LOG_INFO("Reset du Sender detecte (Saut de sequence ignore)");
             }
         }
     }
@@ -61,20 +107,172 @@ static void updateRemoteSensor(RemoteSensorData &sensor, float temp, float hum,
     sensor.packetsReceived++;
 }
 
-void updateRemoteData(uint8_t sensorId, float temp, float hum, int rssi, int snr, uint8_t sequence) {
+bool updateRemoteData(uint8_t sensorId, float temp, float hum, int rssi, int snr, uint8_t sequence,
+                      uint32_t capturedAt) {
+    bool stored = false;
     if (xSemaphoreTake(dataMutex, portMAX_DELAY)) {
-        if (sensorId == CAFETERIA_ID) {
-            Serial.println("[DataManager] Mise a jour CAFET -> Memoire Partagee");
-            updateRemoteSensor(currentState.cafeteria, temp, hum, rssi, snr, sequence);
-        } else if (sensorId == FABLAB_ID) {
-            Serial.println("[DataManager] Mise a jour FABLAB -> Memoire Partagee");
-            updateRemoteSensor(currentState.fablab, temp, hum, rssi, snr, sequence);
-        } else {
-            Serial.print("[DataManager] ID Inconnu ignore: ");
-            Serial.println(sensorId);
+        RemoteSensorData *node = findNode(sensorId, true);
+        if (node != NULL) {
+            LOG_DEBUG("Mise a jour capteur %u -> Memoire Partagee", sensorId);
+            updateRemoteSensor(*node, temp, hum, rssi, snr, sequence, capturedAt);
+            stored = true;
+        }
+        xSemaphoreGive(dataMutex);
+    }
+    if (!stored) LOG_WARN("Table des capteurs pleine, ID %u ignore", sensorId);
+    return stored;
+}
+
+void pushRemoteReading(uint8_t sensorId, float temp, float hum, uint32_t capturedAt) {
+    if (xSemaphoreTake(dataMutex, portMAX_DELAY)) {
+        RemoteSensorData *node = findNode(sensorId, false);
+        // Une lecture plus ancienne que celle affichée ne la remplace pas
+        if (node != NULL && capturedAt >= node->capturedAt) {
+            node->temperature = toCenti(temp);
+            node->humidity = toCenti(hum);
+            node->capturedAt = capturedAt;
+        }
+        xSemaphoreGive(dataMutex);
+    }
+}
+
+void recordRecoveredPacket(uint8_t sensorId) {
+    if (xSemaphoreTake(dataMutex, portMAX_DELAY)) {
+        RemoteSensorData *node = findNode(sensorId, false);
+        if (node != NULL) {
+            if (node->packetsLost > 0) node->packetsLost--;
+            node->packetsReceived++;
+        }
+        xSemaphoreGive(dataMutex);
+    }
+}
+
+SeqStatus acceptRemoteSequence(uint8_t sensorId, uint8_t sequence) {
+    SeqStatus status = SEQ_NEW;
+    if (xSemaphoreTake(dataMutex, portMAX_DELAY)) {
+        RemoteSensorData *node = findNode(sensorId, true);
+        if (node != NULL) status = seq_window_accept(&node->window, sequence);
+        xSemaphoreGive(dataMutex);
+    }
+    return status;
+}
+
+void getRemoteAckState(uint8_t sensorId, uint8_t *cum, uint16_t *map) {
+    *cum = 0;
+    *map = 0;
+    if (xSemaphoreTake(dataMutex, portMAX_DELAY)) {
+        RemoteSensorData *node = findNode(sensorId, false);
+        if (node != NULL) seq_window_state(&node->window, cum, map);
+        xSemaphoreGive(dataMutex);
+    }
+}
+
+void setRemoteHealth(uint8_t sensorId, uint16_t batteryMv, bool hasStatus, uint16_t status) {
+    if (xSemaphoreTake(dataMutex, portMAX_DELAY)) {
+        RemoteSensorData *node = findNode(sensorId, true);
+        if (node != NULL) {
+            node->batteryMv = batteryMv;
+            node->hasStatus = hasStatus;
+            node->status = status;
+        }
+        xSemaphoreGive(dataMutex);
+    }
+}
+
+SeqStatus peekRemoteSequence(uint8_t sensorId, uint8_t sequence) {
+    SeqStatus status = SEQ_NEW;
+    if (xSemaphoreTake(dataMutex, portMAX_DELAY)) {
+        RemoteSensorData *node = findNode(sensorId, false);
+        if (node != NULL) status = seq_window_peek(&node->window, sequence);
+        xSemaphoreGive(dataMutex);
+    }
+    return status;
+}
+
+bool restartRemoteSequence(uint8_t sensorId, uint8_t sequence) {
+    bool restarted = false;
+    if (xSemaphoreTake(dataMutex, portMAX_DELAY)) {
+        RemoteSensorData *node = findNode(sensorId, true);
+        if (node != NULL && !seq_window_recent(&node->window, sequence)) {
+            node->window.valid = false;
+            seq_window_accept(&node->window, sequence);
+            restarted = true;
         }
         xSemaphoreGive(dataMutex);
     }
+    return restarted;
+}
+
+bool canTrackRemoteNode(uint8_t sensorId) {
+    bool ok = false;
+    if (xSemaphoreTake(dataMutex, portMAX_DELAY)) {
+        ok = nodeCount < MAX_REMOTE_NODES || findNode(sensorId, false) != NULL;
+        xSemaphoreGive(dataMutex);
+    }
+    return ok;
+}
+
+void recordRemoteAirtime(uint8_t sensorId, uint32_t airtimeUs) {
+    if (xSemaphoreTake(dataMutex, portMAX_DELAY)) {
+        RemoteSensorData *node = findNode(sensorId, true);
+        if (node != NULL) airtime_window_add(&node->airtime, millis(), airtimeUs);
+        xSemaphoreGive(dataMutex);
+    }
+}
+
+bool reserveGatewayAirtime(uint32_t airtimeUs) {
+    bool allowed = false;
+    if (xSemaphoreTake(dataMutex, portMAX_DELAY)) {
+        GatewayRadioStats &radio = currentState.radio;
+        allowed = airtime_window_allows(&radio.txAirtime, millis(), airtimeUs);
+        if (allowed) airtime_window_add(&radio.txAirtime, millis(), airtimeUs);
+        else radio.txRefused++;
+        xSemaphoreGive(dataMutex);
+    }
+    return allowed;
+}
+
+void recordRxBlindWindow(uint32_t blindUs) {
+    if (xSemaphoreTake(dataMutex, portMAX_DELAY)) {
+        GatewayRadioStats &radio = currentState.radio;
+        airtime_window_add(&radio.rxBlind, millis(), blindUs);
+        radio.rxBlindWindows++;
+        if (blindUs > radio.rxBlindMaxUs) radio.rxBlindMaxUs = blindUs;
+        xSemaphoreGive(dataMutex);
+    }
+}
+
+bool registerRemoteNode(uint8_t sensorId) {
+    bool stored = false;
+    if (xSemaphoreTake(dataMutex, portMAX_DELAY)) {
+        stored = findNode(sensorId, true) != NULL;
+        xSemaphoreGive(dataMutex);
+    }
+    return stored;
+}
+
+bool getRemoteNode(uint8_t sensorId, RemoteSensorData *out) {
+    bool found = false;
+    if (xSemaphoreTake(dataMutex, portMAX_DELAY)) {
+        RemoteSensorData *node = findNode(sensorId, false);
+        if (node != NULL) {
+            *out = *node;
+            found = true;
+        }
+        xSemaphoreGive(dataMutex);
+    }
+    return found;
+}
+
+size_t getRemoteNodeIds(uint8_t *ids, size_t cap) {
+    size_t n = 0;
+    if (xSemaphoreTake(dataMutex, portMAX_DELAY)) {
+        for (size_t i = 0; i < MAX_REMOTE_NODES && n < cap; i++) {
+            if (nodes[i].used) ids[n++] = nodes[i].nodeId;
+        }
+        xSemaphoreGive(dataMutex);
+    }
+    return n;
 }
 
 void setLoraStatus(bool isConnected) {
@@ -112,43 +310,65 @@ void setTimeSyncStatus(bool isSynced) {
     }
 }
 
-void setMqttSequence(const char* id, uint32_t seq) {
+void setMqttSequence(uint8_t sensorId, uint32_t seq) {
     if (xSemaphoreTake(dataMutex, portMAX_DELAY)) {
-        if (strcmp(id, "cafeteria") == 0) {
-            currentState.mqttSequenceCafet = seq;
-            currentState.mqttHandshakeDoneCafet = true;
-        } else if (strcmp(id, "fablab") == 0) {
-            currentState.mqttSequenceFablab = seq;
-            currentState.mqttHandshakeDoneFablab = true;
+        if (sensorId == CAFETERIA_ID) {
+            currentState.mqttSequenceLocal = seq;
+            currentState.mqttHandshakeDoneLocal = true;
+        } else {
+            RemoteSensorData *node = findNode(sensorId, false);
+            if (node != NULL) {
+                node->mqttSequence = seq;
+                node->mqttHandshakeDone = true;
+            }
         }
         xSemaphoreGive(dataMutex);
     }
 }
 
-uint32_t getNextMqttSequence(const char* id) {
+uint32_t getNextMqttSequence(uint8_t sensorId) {
     uint32_t seq = 0;
     if (xSemaphoreTake(dataMutex, portMAX_DELAY)) {
-        if (strcmp(id, "cafeteria") == 0) seq = currentState.mqttSequenceCafet++;
-        else if (strcmp(id, "fablab") == 0) seq = currentState.mqttSequenceFablab++;
+        if (sensorId == CAFETERIA_ID) {
+            seq = currentState.mqttSequenceLocal++;
+        } else {
+            RemoteSensorData *node = findNode(sensorId, false);
+            if (node != NULL) seq = node->mqttSequence++;
+        }
         xSemaphoreGive(dataMutex);
     }
     return seq;
 }
 
-bool isMqttHandshakeDone(const char* id) {
+bool isMqttHandshakeDone(uint8_t sensorId) {
     bool done = false;
     if (xSemaphoreTake(dataMutex, portMAX_DELAY)) {
-        if (strcmp(id, "cafeteria") == 0) done = currentState.mqttHandshakeDoneCafet;
-        else if (strcmp(id, "fablab") == 0) done = currentState.mqttHandshakeDoneFablab;
+        if (sensorId == CAFETERIA_ID) {
+            done = currentState.mqttHandshakeDoneLocal;
+        } else {
+            RemoteSensorData *node = findNode(sensorId, false);
+            done = (node != NULL) && node->mqttHandshakeDone;
+        }
         xSemaphoreGive(dataMutex);
     }
     return done;
 }
 
-void setMqttHandshakeDone(const char* id, bool done) {
+void resetMqttHandshakes() {
     if (xSemaphoreTake(dataMutex, portMAX_DELAY)) {
-        if (strcmp(id, "cafeteria") == 0) currentState.mqttHandshakeDoneCafet = done;
-        else if (strcmp(id, "fablab") == 0) currentState.mqttHandshakeDoneFablab = done;
+        currentState.mqttHandshakeDoneLocal = false;
+        for (size_t i = 0; i < MAX_REMOTE_NODES; i++) nodes[i].mqttHandshakeDone = false;
+        xSemaphoreGive(dataMutex);
+    }
+}
+
+void setRemotePublished(uint8_t sensorId, uint32_t packetsReceived, bool stale) {
+    if (xSemaphoreTake(dataMutex, portMAX_DELAY)) {
+        RemoteSensorData *node = findNode(sensorId, false);
+        if (node != NULL) {
+            node->mqttPublishedPackets = packetsReceived;
+            node->mqttWasStale = stale;
+        }
         xSemaphoreGive(dataMutex);
     }
 }
@@ -2,29 +2,57 @@
 #define DATA_MANAGER_H
 
 #include <Arduino.h>
+#include <lora_airtime.h>
 #include "../config.h"
+#include "ack_tracker.h"
 
+// Valeur centième d'un capteur en erreur (comme dans les trames LoRa)
+#define SENSOR_VALUE_NAN LORA_SENSOR_ERROR
+
+inline float centiToFloat(int16_t v) { return (v == SENSOR_VALUE_NAN) ? NAN : v / 100.0; }
+
+// Enregistrement compact d'un capteur distant (table des noeuds, clé = sensor ID)
 struct RemoteSensorData {
-    float temperature = NAN;
-    float humidity = NAN;
-    uint32_t lastUpdate = 0;
-    
-    // LoRa Diagnostics
-    int rssi = 0;
-    int snr = 0;
-    uint8_t lastSequence = 0;
-    uint32_t packetsLost = 0;
-    uint32_t packetsReceived = 0;
+    uint8_t nodeId;
+    bool used;
+    uint8_t lastSequence;
+    int8_t snr;
+    int16_t rssi;
+    int16_t temperature;      // 1/100 °C, SENSOR_VALUE_NAN = erreur capteur
+    int16_t humidity;         // 1/100 %
+    uint32_t lastUpdate;      // millis() de la dernière trame
+    uint32_t capturedAt;      // Heure Unix de la mesure (trames BATCH/MEASURE), 0 = à la réception
+    uint16_t batteryMv;       // Trames MEASURE, 0 = inconnue
+    uint16_t status;          // LORA_STATUS_* de la dernière trame MEASURE
+    bool hasStatus;
+
+    // Pertes / fenêtre de l'ACK cumulatif
+    uint32_t packetsLost;
+    uint32_t packetsReceived;
+    SeqWindow window;
+    AirtimeWindow airtime;    // Temps d'antenne de ses trames reçues, heure glissante
+
+    // MQTT
+    uint32_t mqttSequence;
+    uint32_t mqttPublishedPackets; // packetsReceived à la dernière publication
+    bool mqttHandshakeDone;
+    bool mqttWasStale;
+};
+
+// Radio de la passerelle: temps d'antenne de ses émissions (ACK, réponses,
+// beacons) et fenêtres de surdité RX (commande TX -> réception réarmée)
+struct GatewayRadioStats {
+    AirtimeWindow txAirtime;
+    uint32_t txRefused;       // Emissions refusées (budget de duty cycle atteint)
+    AirtimeWindow rxBlind;    // Temps sourd, heure glissante
+    uint32_t rxBlindWindows;
+    uint32_t rxBlindMaxUs;
 };
 
 struct SystemData {
     // Valeurs des capteurs
     float localTemperature;
     float localHumidity;
-    
-    // Données des capteurs distants
-    RemoteSensorData cafeteria;
-    RemoteSensorData fablab;
 
     // Statut des modules
     bool loraModuleConnected;
@@ -33,18 +61,54 @@ struct SystemData {
     bool mqttConnected;
     bool timeSynced;
 
-    // Sécurité MQTT
-    uint32_t mqttSequenceCafet;
-    uint32_t mqttSequenceFablab;
-    bool mqttHandshakeDoneCafet;
-    bool mqttHandshakeDoneFablab;
+    // Sécurité MQTT du capteur local (CAFETERIA_ID)
+    uint32_t mqttSequenceLocal;
+    bool mqttHandshakeDoneLocal;
+
+    GatewayRadioStats radio;
 };
 
 void initDataManager();
 
 // Fonctions de mise à jour des données
 void updateLocalData(float temp, float hum);
-void updateRemoteData(uint8_t sensorId, float temp, float hum, int rssi = 0, int snr = 0, uint8_t sequence = 0);
+
+// --- Capteurs distants: table à adressage ouvert de MAX_REMOTE_NODES entrées ---
+// Un capteur inconnu est ajouté à sa première trame; false si la table est pleine.
+bool updateRemoteData(uint8_t sensorId, float temp, float hum, int rssi = 0, int snr = 0, uint8_t sequence = 0,
+                      uint32_t capturedAt = 0);
+// Tension batterie (0 = pas de mesure) et mot d'état d'une trame MEASURE
+void setRemoteHealth(uint8_t sensorId, uint16_t batteryMv, bool hasStatus, uint16_t status);
+// Lecture suivante d'une trame BATCH: valeur et heure de mesure seulement, sans
+// toucher aux compteurs de trames (la trame est comptée une fois)
+void pushRemoteReading(uint8_t sensorId, float temp, float hum, uint32_t capturedAt);
+// Trame comptée perdue puis reçue par retransmission (ACK cumulatif)
+void recordRecoveredPacket(uint8_t sensorId);
+// Fenêtre de l'ACK cumulatif du capteur (SEQ_NEW si la table est pleine)
+SeqStatus acceptRemoteSequence(uint8_t sensorId, uint8_t sequence);
+void getRemoteAckState(uint8_t sensorId, uint8_t *cum, uint16_t *map);
+// Statut qu'aurait la séquence, sans l'enregistrer (filtre avant vérification du MAC)
+SeqStatus peekRemoteSequence(uint8_t sensorId, uint8_t sequence);
+// Capteur redémarré (compteur de séquence repassé à 0): la fenêtre repart de
+// `sequence`, sauf si elle est récente (retransmission tardive). true si redémarrée.
+bool restartRemoteSequence(uint8_t sensorId, uint8_t sequence);
+// Capteur déjà connu, ou place libre dans la table pour l'ajouter
+bool canTrackRemoteNode(uint8_t sensorId);
+
+// Temps d'antenne d'une trame authentifiée du capteur
+void recordRemoteAirtime(uint8_t sensorId, uint32_t airtimeUs);
+
+// Emission de la passerelle: réserve son temps d'antenne, false (comptée
+// refusée) si elle dépasserait le budget de duty cycle de l'heure
+bool reserveGatewayAirtime(uint32_t airtimeUs);
+void recordRxBlindWindow(uint32_t blindUs);
+
+// Ajoute un capteur avant sa première trame, false si la table est pleine
+bool registerRemoteNode(uint8_t sensorId);
+// Copie de l'enregistrement d'un capteur, false s'il est inconnu
+bool getRemoteNode(uint8_t sensorId, RemoteSensorData *out);
+// IDs des capteurs connus (au plus cap), pour les parcourir
+size_t getRemoteNodeIds(uint8_t *ids, size_t cap);
 
 // Fonctions de mise à jour des statuts
 void setLoraStatus(bool isConnected);
@@ -53,11 +117,12 @@ void setWifiStatus(bool isConnected);
 void setMqttStatus(bool isConnected);
 void setTimeSyncStatus(bool isSynced);
 
-// Sécurité MQTT
-void setMqttSequence(const char* id, uint32_t seq);
-uint32_t getNextMqttSequence(const char* id);
-bool isMqttHandshakeDone(const char* id);
-void setMqttHandshakeDone(const char* id, bool done);
+// Sécurité MQTT, par capteur (CAFETERIA_ID = capteur local de la passerelle)
+void setMqttSequence(uint8_t sensorId, uint32_t seq);
+uint32_t getNextMqttSequence(uint8_t sensorId);
+bool isMqttHandshakeDone(uint8_t sensorId);
+void resetMqttHandshakes();
+void setRemotePublished(uint8_t sensorId, uint32_t packetsReceived, bool stale);
 
 // Fonction pour récupérer tout l'état
 SystemData getSystemData();
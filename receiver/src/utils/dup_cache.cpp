@@ -0,0 +1,51 @@
+#include "dup_cache.h"
+#include "../config.h"
+
+static DupCacheEntry entries[LORA_DUP_CACHE_SIZE];
+
+DupCacheEntry *dup_cache_find(const LoraFrameView &frame, uint32_t nowMs) {
+    if (frame.bodyLen == 0 || frame.tagLen < DUP_CACHE_MIN_TAG_LEN || frame.tagLen > LORA_FULL_TAG_LEN) {
+        return NULL;
+    }
+    for (size_t i = 0; i < LORA_DUP_CACHE_SIZE; i++) {
+        DupCacheEntry &e = entries[i];
+        if (!e.used || e.nodeId != frame.nodeId || e.sequence != frame.body[0] || e.type != frame.type) continue;
+        if (nowMs - e.acceptedMs > LORA_DUP_CACHE_TTL_MS) {
+            e.used = false;
+            continue;
+        }
+        if (e.tagLen != frame.tagLen || memcmp(e.tag, frame.tag, frame.tagLen) != 0) continue;
+        e.lastSeenMs = nowMs;
+        return &e;
+    }
+    return NULL;
+}
+
+DupCacheEntry *dup_cache_insert(const LoraFrameView &frame, uint32_t nowMs) {
+    if (frame.bodyLen == 0 || frame.tagLen < DUP_CACHE_MIN_TAG_LEN || frame.tagLen > LORA_FULL_TAG_LEN) {
+        return NULL;
+    }
+
+    // Free slot, else the one used the longest ago
+    DupCacheEntry *victim = &entries[0];
+    for (size_t i = 0; i < LORA_DUP_CACHE_SIZE; i++) {
+        if (!entries[i].used) { victim = &entries[i]; break; }
+        if (nowMs - entries[i].lastSeenMs > nowMs - victim->lastSeenMs) victim = &entries[i];
+    }
+
+    victim->used = true;
+    victim->nodeId = frame.nodeId;
+    victim->type = frame.type;
+    victim->sequence = frame.body[0];
+    victim->tagLen = frame.tagLen;
+    memcpy(victim->tag, frame.tag, frame.tagLen);
+    victim->acceptedMs = victim->lastSeenMs = nowMs;
+    victim->ackLen = 0;
+    return victim;
+}
+
+void dup_cache_set_ack(DupCacheEntry *entry, const uint8_t *ack, size_t len) {
+    if (entry == NULL || len > DUP_CACHE_ACK_MAX) return;
+    memcpy(entry->ack, ack, len);
+    entry->ackLen = (uint8_t)len;
+}
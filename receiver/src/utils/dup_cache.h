@@ -0,0 +1,44 @@
+#ifndef DUP_CACHE_H
+#define DUP_CACHE_H
+
+#include <Arduino.h>
+#include <lora_protocol.h>
+
+// Frames accepted during the last LORA_DUP_CACHE_TTL_MS, keyed by (node, type,
+// sequence, full tag), with the ACK that answered them. A retransmission the
+// node sends after losing that ACK is the same bytes, so it matches without
+// the MAC being computed again: the gateway replays the ACK and counts nothing.
+// Only the exact tag that passed the MAC check matches, so an ACK re-signed on
+// a hit is bound to that tag and to nothing an eavesdropper chose.
+//
+// Entries expire so a node that reuses a sequence after a restart, with the
+// same reading, is not taken for a retransmission. Least recently used entry
+// evicted when full.
+//
+// Called from the LoRa task only: no locking.
+
+#define DUP_CACHE_MIN_TAG_LEN 4   // Shortest tag of the protocol
+#define DUP_CACHE_ACK_MAX (3 + LORA_ACK_TIME_BODY_LEN + LORA_FULL_TAG_LEN)
+
+struct DupCacheEntry {
+    uint8_t nodeId;
+    uint8_t type;
+    uint8_t sequence;
+    bool used;
+    uint8_t tagLen;
+    uint8_t tag[LORA_FULL_TAG_LEN];   // Tag verified when the frame was accepted
+    uint32_t acceptedMs;
+    uint32_t lastSeenMs;
+    uint8_t ackLen;           // 0 = frame sent with LORA_HDR_NO_ACK, nothing to replay
+    uint8_t ack[DUP_CACHE_ACK_MAX];
+};
+
+// Entry of a DATA/BATCH frame accepted within the TTL, NULL if there is none
+DupCacheEntry *dup_cache_find(const LoraFrameView &frame, uint32_t nowMs);
+
+// Records an authenticated DATA/BATCH frame; attach its ACK with dup_cache_set_ack
+DupCacheEntry *dup_cache_insert(const LoraFrameView &frame, uint32_t nowMs);
+
+void dup_cache_set_ack(DupCacheEntry *entry, const uint8_t *ack, size_t len);
+
+#endif
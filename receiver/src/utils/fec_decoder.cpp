@@ -0,0 +1,87 @@
+#include "fec_decoder.h"
+#include "../config.h"
+
+#define FEC_MAX_NODES MAX_REMOTE_NODES
+
+struct FecNode {
+    uint8_t nodeId;
+    bool used;
+    uint8_t count;        // Valid entries (ring not full yet)
+    uint8_t pos;          // Next entry to overwrite
+    uint8_t sequence[LORA_FEC_MAX_GROUP];
+    uint8_t reading[LORA_FEC_MAX_GROUP][LORA_FEC_PAYLOAD_LEN];
+    uint32_t lastSeen;
+};
+
+static FecNode nodes[FEC_MAX_NODES];
+
+static FecNode *findNode(uint8_t nodeId, bool create) {
+    FecNode *oldest = &nodes[0];
+    for (size_t i = 0; i < FEC_MAX_NODES; i++) {
+        if (nodes[i].used && nodes[i].nodeId == nodeId) return &nodes[i];
+    }
+    if (!create) return NULL;
+    // New node: free slot, else the one heard the longest ago
+    for (size_t i = 0; i < FEC_MAX_NODES; i++) {
+        if (!nodes[i].used) { oldest = &nodes[i]; break; }
+        if (millis() - nodes[i].lastSeen > millis() - oldest->lastSeen) oldest = &nodes[i];
+    }
+    memset(oldest, 0, sizeof(*oldest));
+    oldest->used = true;
+    oldest->nodeId = nodeId;
+    return oldest;
+}
+
+static int findReading(const FecNode *node, uint8_t sequence) {
+    for (uint8_t i = 0; i < node->count; i++) {
+        if (node->sequence[i] == sequence) return i;
+    }
+    return -1;
+}
+
+void fec_on_data(uint8_t nodeId, uint8_t sequence, const uint8_t *reading) {
+    FecNode *node = findNode(nodeId, true);
+    node->lastSeen = millis();
+
+    // A retransmission replaces its entry instead of pushing another one out
+    int i = findReading(node, sequence);
+    if (i < 0) {
+        i = node->pos;
+        node->pos = (node->pos + 1) % LORA_FEC_MAX_GROUP;
+        if (node->count < LORA_FEC_MAX_GROUP) node->count++;
+    }
+    node->sequence[i] = sequence;
+    memcpy(node->reading[i], reading, LORA_FEC_PAYLOAD_LEN);
+}
+
+bool fec_on_parity(uint8_t nodeId, const uint8_t *body, uint8_t *sequence, uint8_t *reading) {
+    uint8_t first = body[0];
+    uint8_t k = body[1];
+    if (k < 2 || k > LORA_FEC_MAX_GROUP) return false;
+    FecNode *node = findNode(nodeId, false);
+    if (node == NULL) return false;
+
+    uint8_t rebuilt[LORA_FEC_PAYLOAD_LEN];
+    memcpy(rebuilt, body + 2, LORA_FEC_PAYLOAD_LEN);
+    int missing = -1;
+    for (uint8_t j = 0; j < k; j++) {
+        int i = findReading(node, (uint8_t)(first + j));
+        if (i < 0) {
+            if (missing >= 0) return false; // Two or more lost: XOR cannot tell them apart
+            missing = j;
+            continue;
+        }
+        for (uint8_t b = 0; b < LORA_FEC_PAYLOAD_LEN; b++) rebuilt[b] ^= node->reading[i][b];
+    }
+    if (missing < 0) return false;
+
+    *sequence = (uint8_t)(first + missing);
+    memcpy(reading, rebuilt, LORA_FEC_PAYLOAD_LEN);
+    fec_on_data(nodeId, *sequence, reading);
+    return true;
+}
+
+void fec_reset(uint8_t nodeId) {
+    FecNode *node = findNode(nodeId, false);
+    if (node != NULL) node->count = node->pos = 0;
+}
@@ -0,0 +1,24 @@
+#ifndef FEC_DECODER_H
+#define FEC_DECODER_H
+
+#include <Arduino.h>
+#include <lora_protocol.h>
+
+// Gateway side of the PARITY frames (lora_protocol.h). Per node, the readings
+// of the last LORA_FEC_MAX_GROUP authenticated DATA frames; a parity frame
+// that finds all of its group but one gives the missing reading back.
+//
+// Called from the LoRa task only: no locking.
+
+// Records the reading [T_low, T_high, H_low, H_high] of a DATA frame
+void fec_on_data(uint8_t nodeId, uint8_t sequence, const uint8_t *reading);
+
+// Parity body [FIRST, K, XOR]: true if exactly one frame of the group is
+// missing, with its sequence and rebuilt reading (also recorded)
+bool fec_on_parity(uint8_t nodeId, const uint8_t *body, uint8_t *sequence, uint8_t *reading);
+
+// The node restarted its sequence counter: readings kept under the old
+// sequences must not be mixed with the new ones
+void fec_reset(uint8_t nodeId);
+
+#endif
@@ -0,0 +1,153 @@
+#ifndef LORA_MODEM_H
+#define LORA_MODEM_H
+
+#include <Arduino.h>
+#include <Arduino_FreeRTOS.h>
+#include <lora_protocol.h>
+#include <lora_rx_parser.h>
+#include <lora_airtime.h>
+
+// Event-driven driver for the Wio-E5 in AT test mode (Serial1).
+// A pump task owns the UART: it writes queued commands one at a time, splits
+// the modem output into lines as bytes arrive, completes the current command
+// as soon as its terminal line shows up ("+AT: OK", "+TEST: TX DONE", ...)
+// and routes the RX URCs to a frame queue. Callers block on a task
+// notification instead of sleeping for fixed timeouts.
+//
+// On the UNO R4 the SCI receive interrupt of Serial1 is taken over: each byte
+// goes from the ISR into a stream buffer, the ISR timestamps every completed
+// line and wakes the pump only then. Elsewhere the pump polls Serial1 once
+// per tick.
+
+#if defined(ARDUINO_UNOR4_WIFI) || defined(ARDUINO_UNOR4_MINIMA)
+#define LORA_MODEM_UART_ISR 1
+#else
+#define LORA_MODEM_UART_ISR 0
+#endif
+
+enum ModemResult : uint8_t {
+    MODEM_OK = 0,
+    MODEM_ERROR,    // "+XXX: ERROR(n)" from the module
+    MODEM_TIMEOUT,  // no terminal line before the deadline
+    MODEM_BUSY      // command queue full / modem not started
+};
+
+// Line-level counters, readable from any task
+struct LoRaModemStats {
+    uint32_t lines;          // complete lines handled
+    uint32_t rejected;       // oversized lines + malformed receive URCs
+    uint32_t framesDropped;  // valid frames lost because the frame queue was full
+    uint32_t maxLineUs;      // worst-case time spent on one line
+    uint32_t uartOverruns;   // bytes lost because the ISR stream buffer was full
+};
+
+// Frame received in test mode ("+TEST: RX"), hex-decoded, with the
+// RSSI/SNR of the "+TEST: LEN:..., RSSI:..., SNR:..." line before it
+struct LoraRxPacket {
+    uint8_t frame[LORA_MAX_FRAME_LEN];
+    size_t len;
+    int rssi;
+    int snr;
+    uint32_t timestampUs;    // micros() when the RX line ended (taken in the UART ISR)
+};
+
+class LoRaModem {
+public:
+    static const uint32_t WAIT_FOREVER = 0xFFFFFFFF;
+
+    // Opens Serial1 and starts the pump task. Call once.
+    bool begin(unsigned long baud);
+
+    // Queues cmd and blocks until a line containing `expect` (MODEM_OK), an
+    // ERROR line or timeoutMs. cmd and expect must stay valid until it returns;
+    // CRLF is appended unless cmd already ends with it.
+    ModemResult command(const char *cmd, const char *expect, uint32_t timeoutMs = 1000);
+
+    // AT+TEST=TXLRPKT, returns once "+TEST: TX DONE" is seen (timeout: txTimeoutMs)
+    ModemResult transmit(const uint8_t *frame, size_t len, uint32_t timeoutMs);
+
+    // AT+TEST=RFCFG: 868 MHz, BW125, CR4/5, preamble 12/15 (lora_airtime.h), at
+    // the given SF and TX power. Applies to both directions; re-arm RX afterwards if needed.
+    ModemResult configure(uint8_t sf, int8_t powerDbm);
+
+    // Time on air of a len-byte frame at the SF last configured
+    uint32_t timeOnAirUs(size_t len) const { return lora_time_on_air_us(_sf, len); }
+
+    // Wait for TX DONE: time on air plus the AT command (hex over the UART, module latency)
+    static const uint32_t TX_AT_MARGIN_MS = 500;
+    uint32_t txTimeoutMs(size_t len) const { return timeOnAirUs(len) / 1000 + TX_AT_MARGIN_MS; }
+
+    // AT+TEST=RXLRPKT: continuous reception until the next TX
+    ModemResult startReceive();
+
+    // AT+TEST=RSSI: channel energy at the RFCFG frequency, averaged by the
+    // module, in *rssiDbm. MODEM_ERROR if the firmware has no RSSI test.
+    ModemResult channelRssi(int *rssiDbm);
+
+    // Next received frame, waiting up to timeoutMs (WAIT_FOREVER to block)
+    bool receive(LoraRxPacket *packet, uint32_t timeoutMs);
+
+    // Drops frames still queued from an earlier exchange
+    void flushReceived();
+
+    LoRaModemStats stats() const { return _stats; }
+
+private:
+    struct PendingCommand {
+        const char *text;
+        const char *expect;
+        uint32_t timeoutMs;
+        TaskHandle_t waiter;
+    };
+
+    static const size_t LINE_MAX = 160;
+    static const size_t RESPONSE_MAX = 40;
+    static const UBaseType_t CMD_QUEUE_LEN = 4;
+    static const UBaseType_t RX_QUEUE_LEN = 2;
+    static const size_t UART_STREAM_LEN = 256;
+    static const uint8_t LINE_STAMPS = 8;   // power of two
+
+    static void pumpTask(void *pvParameters);
+    void pump();
+    void drainUart();
+    void startCommand();
+    void finishCommand(ModemResult result);
+    void feed(char c);
+    void handleLine(const char *line, size_t len, uint32_t timestampUs);
+
+#if LORA_MODEM_UART_ISR
+    bool installUartIsr();
+    static void uartCallback(uart_callback_args_t *p_args);
+#endif
+
+    QueueHandle_t _cmdQueue = NULL;
+    QueueHandle_t _rxQueue = NULL;
+    TaskHandle_t _pumpTask = NULL;
+
+    // ISR -> pump: raw bytes, plus one timestamp per '\n' (written by the ISR only)
+    StreamBufferHandle_t _uartStream = NULL;
+    uint32_t _lineStamps[LINE_STAMPS];
+    volatile uint8_t _stampHead = 0;
+    uint8_t _stampTail = 0;
+    bool _isrRx = false;
+
+    PendingCommand _active;
+    bool _busy = false;
+    uint32_t _deadline = 0;
+    char _response[RESPONSE_MAX + 1];  // terminal line of the last command (cut)
+    uint8_t _sf = LORA_DEFAULT_SF;
+
+    char _line[LINE_MAX + 1];
+    size_t _lineLen = 0;
+    bool _lineOverflow = false;
+
+    LoraRxMeta _lastMeta = { -1, 0, 0 };
+    LoraRxPacket _rx;
+    LoRaModemStats _stats = {};
+
+    // "AT+TEST=TXLRPKT,\"<hex>\"" built in place by transmit()
+    char _txCommand[sizeof("AT+TEST=TXLRPKT,\"") - 1 + 2 * LORA_MAX_FRAME_LEN + sizeof("\"\r\n")];
+    char _cfgCommand[sizeof("AT+TEST=RFCFG,868,SF12,125,12,15,-128\r\n")];
+};
+
+#endif
@@ -0,0 +1,52 @@
+#include "node_keys.h"
+#include "../config.h"
+
+struct NodeKeyConfig {
+    uint8_t nodeId;
+    const char *secret;
+};
+
+struct NodeKeyEntry {
+    uint8_t nodeId;
+    MacKey key;
+};
+
+static const NodeKeyConfig nodeKeyConfig[] = LORA_NODE_KEYS;
+static const size_t NODE_KEY_CONFIG_COUNT = sizeof(nodeKeyConfig) / sizeof(nodeKeyConfig[0]);
+
+static NodeKeyEntry nodeKeys[MAX_NODE_KEYS];
+static size_t nodeKeyCount = 0;
+static MacKey sharedKey;
+
+void initNodeKeys() {
+    mac_key_init(&sharedKey, (const uint8_t*)LORA_SHARED_SECRET, strlen(LORA_SHARED_SECRET));
+
+    nodeKeyCount = 0;
+    for (size_t i = 0; i < NODE_KEY_CONFIG_COUNT && nodeKeyCount < MAX_NODE_KEYS; i++) {
+        const NodeKeyConfig &cfg = nodeKeyConfig[i];
+        nodeKeys[nodeKeyCount].nodeId = cfg.nodeId;
+        mac_key_init(&nodeKeys[nodeKeyCount].key, (const uint8_t*)cfg.secret, strlen(cfg.secret));
+        nodeKeyCount++;
+    }
+    if (NODE_KEY_CONFIG_COUNT > MAX_NODE_KEYS) {
+        Serial.println("[NodeKeys] LORA_NODE_KEYS depasse MAX_NODE_KEYS, entrees ignorees !");
+    }
+}
+
+const MacKey *getNodeKey(uint8_t nodeId) {
+    for (size_t i = 0; i < nodeKeyCount; i++) {
+        if (nodeKeys[i].nodeId == nodeId) return &nodeKeys[i].key;
+    }
+    return &sharedKey;
+}
+
+bool hasNodeKey(uint8_t nodeId) {
+    for (size_t i = 0; i < nodeKeyCount; i++) {
+        if (nodeKeys[i].nodeId == nodeId) return true;
+    }
+    return false;
+}
+
+const MacKey *getSharedKey() {
+    return &sharedKey;
+}
@@ -0,0 +1,21 @@
+#ifndef NODE_KEYS_H
+#define NODE_KEYS_H
+
+#include <Arduino.h>
+#include <security_utils.h>
+
+// Precompute the MAC keys (HMAC midstates + SipHash key) of the shared secret
+// and of every node listed in LORA_NODE_KEYS. Must be called once from setup(), before the scheduler:
+// the table is read-only afterwards and needs no mutex.
+void initNodeKeys();
+
+// Key used to authenticate LoRa frames from/to a node (falls back to the shared secret)
+const MacKey *getNodeKey(uint8_t nodeId);
+
+// True if LORA_NODE_KEYS lists the node
+bool hasNodeKey(uint8_t nodeId);
+
+// Key of LORA_SHARED_SECRET (MQTT signatures, unknown nodes)
+const MacKey *getSharedKey();
+
+#endif
@@ -1,4 +1,5 @@
 #include "sleep_manager.h"
+#include "logger.h"
 #include <WiFiS3.h> // Required to control the ESP32 module
 
 // Flag to indicate wake-up source
@@ -17,6 +18,9 @@ void SleepManager::alarmCallback() {
 }
 
 void SleepManager::deepSleep(int secondsDuration) {
+    // Let the deferred log catch up before writing to Serial directly
+    logger_flush();
+
     Serial.print("[SleepManager] Entering Deep Sleep for ");
     Serial.print(secondsDuration);
     Serial.println("s...");
@@ -3,6 +3,9 @@
 #include <WiFiUdp.h>
 #include <RTC.h>
 
+#define LOG_MODULE "TimeManager"
+#include "logger.h"
+
 static const char* ntpServerName = "pool.ntp.org";
 static const unsigned int localPort = 2390; // Local port to listen for UDP packets
 static const int NTP_PACKET_SIZE = 48;
@@ -10,6 +13,36 @@ static byte packetBuffer[NTP_PACKET_SIZE];
 
 WiFiUDP Udp;
 
+// millis() at the last RTC second edge, and an edge counter to detect an edge
+// between reading the RTC and reading edgeMs
+static volatile uint32_t edgeMs = 0;
+static volatile uint32_t edgeCount = 0;
+
+static void onRtcSecond() {
+    edgeMs = millis();
+    edgeCount++;
+}
+
+void initRtcSubSeconds() {
+    if (!RTC.setPeriodicCallback(onRtcSecond, Period::ONCE_EVERY_1_SEC)) {
+        LOG_WARN("RTC periodic interrupt unavailable, time without milliseconds.");
+    }
+}
+
+uint32_t getRtcTimeMs(uint16_t *ms) {
+    RTCTime current;
+    uint32_t count, elapsed;
+    do {
+        count = edgeCount;
+        RTC.getTime(current);
+        elapsed = millis() - edgeMs;
+    } while (count != edgeCount);
+
+    // No edge yet (or setTime() restarted the second): millis() cannot place us
+    *ms = (count == 0 || elapsed > 999) ? 0 : (uint16_t)elapsed;
+    return current.getUnixTime();
+}
+
 // Sends an NTP request to the time server at the given address
 static void sendNTPpacket(const char* address) {
   memset(packetBuffer, 0, NTP_PACKET_SIZE);
@@ -31,7 +64,7 @@ static void sendNTPpacket(const char* address) {
 }
 
 bool syncTimeWithNTP() {
-    Serial.println("[TimeManager] Syncing NTP...");
+    LOG_INFO("Syncing NTP...");
     Udp.begin(localPort);
     
     sendNTPpacket(ntpServerName);
@@ -40,7 +73,7 @@ bool syncTimeWithNTP() {
     unsigned long start = millis();
     while (Udp.parsePacket() == 0) {
         if (millis() - start > 1500) {
-            Serial.println("[TimeManager] Timeout waiting for NTP response.");
+            LOG_WARN("Timeout waiting for NTP response.");
             Udp.stop();
             return false;
         }
@@ -67,8 +100,7 @@ bool syncTimeWithNTP() {
     RTCTime timeToSet(epoch); 
     RTC.setTime(timeToSet);
 
-    Serial.print("[TimeManager] RTC Updated. Unix Time: ");
-    Serial.println(epoch);
+    LOG_INFO("RTC Updated. Unix Time: %lu", epoch);
 
     Udp.stop();
     return true;
@@ -11,4 +11,19 @@
  */
 bool syncTimeWithNTP();
 
+/**
+ * @brief Starts timestamping the RTC second edges (1 Hz periodic interrupt),
+ * so getRtcTimeMs() can add the time elapsed since the last edge.
+ * Call once, after RTC.begin().
+ */
+void initRtcSubSeconds();
+
+/**
+ * @brief Current Unix time with millisecond resolution.
+ *
+ * @param ms Receives the milliseconds elapsed in the current second (0-999).
+ * @return Seconds from the RTC.
+ */
+uint32_t getRtcTimeMs(uint16_t *ms);
+
 #endif
@@ -9,6 +9,7 @@
 #include "src/tasks/ui_task.h"
 #include "src/utils/data_manager.h"
 #include "src/utils/sleep_manager.h"
+#include "src/utils/logger.h"
 
 void setup() {
   Serial.begin(115200);
@@ -20,6 +21,7 @@ void setup() {
 
   initDataManager();
   SleepManager::begin();
+  logger_begin();
 
   BaseType_t res;
 
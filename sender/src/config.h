@@ -14,6 +14,58 @@
 
 // LoRa Protocol
 #define SENSOR_ID 0x01 // Identifiant unique de ce capteur
+#define LORA_PROTOCOL_VERSION 1 // 0 = legacy (HMAC complet), 1 = HMAC-SHA256 tronqué, 2 = SipHash-2-4
+#define LORA_TAG_LEN 8          // v1: 4, 8, 16 ou 32 octets / v2: 4 ou 8 octets
+
+// Adaptive data rate (v1/v2): SF et puissance recommandés par la passerelle dans l'ACK
+#define LORA_ADR_HYSTERESIS 2       // ACK identiques avant de baisser la puissance
+#define LORA_ADR_FALLBACK_LOSSES 3  // ACK perdus d'affilée avant retour SF7 / 14 dBm
+
+// Politique d'ACK des trames DATA (v1/v2): 0 = chaque trame, 1 = une trame sur
+// LORA_ACK_INTERVAL, 2 = aucun ACK (pas de fenêtre RX, donc pas d'ADR). Les ACK
+// sont cumulatifs: seules les trames qu'ils déclarent manquantes sont renvoyées.
+// En mode 0, l'ACK porte aussi l'heure de la passerelle: plus d'échange TIME_REQ.
+// En TDMA, le mode 2 laisse l'ACK groupé du beacon suivant acquitter la trame,
+// mais sans ADR ni synchro par l'ACK. Avec 0 ou 1, le créneau de la passerelle
+// (LORA_BEACON_SLOT_MS) doit aussi couvrir l'ACK.
+#define LORA_ACK_MODE 0
+#define LORA_ACK_INTERVAL 4
+#define LORA_ACK_MAX_RETRIES 2
+
+// TDMA (v1/v2): le capteur écoute le beacon de la passerelle (heure, créneau,
+// ACK groupé), émet dans son créneau et dort jusqu'au beacon suivant. Sans
+// beacon: émission libre, synchro TIME_REQ et DEEP_SLEEP_INTERVAL_SEC. A activer
+// avec LORA_BEACON_PERIOD_SEC sur la passerelle.
+#define LORA_TDMA 0
+#define LORA_TDMA_WAKE_EARLY_SEC 4  // Réveil avant le beacon (lecture DHT; sans reprise à chaud: + reset, init du module)
+#define LORA_BEACON_LISTEN_SEC 20   // Ecoute max du beacon, > supertrame de la passerelle
+#define LORA_BEACON_SECRET LORA_SHARED_SECRET
+
+// Listen-before-talk: RSSI du canal (AT+TEST=RSSI) avant chaque émission. Canal
+// occupé ou ACK perdu (collision probable): attente aléatoire, fenêtre doublée à
+// chaque échec. Canal libre: aucun délai ajouté.
+#define LORA_LBT 1
+#define LORA_LBT_THRESHOLD_DBM -90  // RSSI au-dessus duquel le canal est occupé
+#define LORA_LBT_BACKOFF_MS 100     // Première fenêtre de backoff
+#define LORA_LBT_MAX_EXPONENT 5     // Fenêtre max: LORA_LBT_BACKOFF_MS << 5 = 3,2 s
+#define LORA_LBT_MAX_BACKOFFS 4     // Canal toujours occupé après autant d'attentes: émission quand même
+#define LORA_LBT_MAX_RETRIES 2      // Nouvel échange après un ACK perdu, avant la veille
+
+// Lectures par trame (v1/v2): 1 = une trame DATA par réveil, N > 1 = une trame
+// BATCH (deltas compressés, un seul MAC/ACK) tous les N réveils. Le buffer est
+// conservé pendant la veille, reset de réveil compris.
+#define LORA_BATCH_SIZE 1
+
+// Format des lectures (v1/v2, LORA_BATCH_SIZE 1): 0 = trame DATA de taille fixe
+// (température, humidité), 1 = trame MEASURE (enregistrements TLV: en plus l'heure
+// de la mesure, l'état du capteur et la tension batterie). La passerelle lit les deux.
+#define LORA_MEASURE_FRAMES 0
+
+// Correction d'erreurs (v1/v2, LORA_BATCH_SIZE 1): une trame PARITY (XOR des
+// lectures) toutes les LORA_FEC_GROUP trames DATA, la passerelle reconstruit une
+// trame perdue du groupe sans retransmission. 0 = désactivé, 2 à 8. En TDMA,
+// LORA_BEACON_SLOT_MS doit couvrir les deux trames.
+#define LORA_FEC_GROUP 0
 
 // Blockchain/Security Configuration
 #define LORA_SHARED_SECRET "IoT_Secure_P@ssw0rd_2026"
@@ -22,8 +74,24 @@
 // Sensor Configuration
 #define SENSOR_DHT_PIN 4
 #define SENSOR_DHT_TYPE DHT22
+#define SENSOR_VBAT 0          // 1 = tension batterie dans les trames MEASURE (pont diviseur)
+#define SENSOR_VBAT_PIN A0
+#define SENSOR_VBAT_DIVIDER 2  // Rapport du pont: Vbat / Vpin
+
+// Logs (0 = off, 1 = erreurs, 2 = warnings, 3 = info, 4 = debug).
+// Les appels au-dessus du niveau d'un module disparaissent à la compilation.
+#define LOG_LEVEL 3
+#define LOG_LEVEL_LORA LOG_LEVEL
+#define LOG_LEVEL_MODEM LOG_LEVEL
+#define LOG_LEVEL_SENSOR LOG_LEVEL
+#define LOG_RING_SIZE 16 // Messages en attente (puissance de 2)
 
 // Power Management
 #define DEEP_SLEEP_INTERVAL_SEC 15 // 15 secondes pour debug
+// Réveil de la veille: 1 = reprise à chaud (RAM, tâches, module LoRa et heure
+// conservés: seulement lecture et émission), 0 = redémarrage complet (setup(),
+// init du module et attente DHT à chaque cycle; séquence, synchro et état radio
+// repris d'un bloc de RAM conservé)
+#define SLEEP_WARM_RESUME 1
 
 #endif // CONFIG_H
\ No newline at end of file
@@ -1,268 +1,1004 @@
 #include <Arduino.h>
 #include <Arduino_FreeRTOS.h>
 #include <RTC.h>
+#include <security_utils.h>
+#include <lora_protocol.h>
+#include <lora_batch.h>
+#include <lora_airtime.h>
+#include <lora_tlv.h>
 #include "../config.h"
 #include "../utils/data_manager.h"
 #include "../utils/sleep_manager.h"
-#include "../utils/security_utils.h"
+#include "../utils/lora_modem.h"
+#include "../utils/retained_state.h"
+
+#define LOG_MODULE "LoRa"
+#define LOG_MODULE_LEVEL LOG_LEVEL_LORA
+#include "../utils/logger.h"
+
+#if LORA_PROTOCOL_VERSION >= LORA_PROTO_V1 && LORA_TAG_LEN != 4 && LORA_TAG_LEN != 8 && LORA_TAG_LEN != 16 && LORA_TAG_LEN != 32
+#error "LORA_TAG_LEN must be 4, 8, 16 or 32"
+#endif
+// LORA_ACK_MODE
+#define LORA_ACK_EVERY 0
+#define LORA_ACK_NTH 1
+#define LORA_ACK_NONE 2
+// Some frames wait for an ACK (and its ADR recommendation)
+#define LORA_EXPECTS_ACK (LORA_ACK_MODE != LORA_ACK_NONE || LORA_BATCH_SIZE > 1)
+// Every reading gets a cumulative ACK carrying the gateway clock: no TIME_REQ
+#define LORA_ACK_SYNC (LORA_PROTOCOL_VERSION >= LORA_PROTO_V1 && LORA_ACK_MODE == LORA_ACK_EVERY && LORA_BATCH_SIZE <= 1)
+#if LORA_ACK_MODE != LORA_ACK_EVERY && LORA_PROTOCOL_VERSION < LORA_PROTO_V1
+#error "Legacy frames are always acknowledged: LORA_ACK_MODE needs protocol v1 or v2"
+#endif
+#if LORA_BATCH_SIZE > 1 && LORA_PROTOCOL_VERSION < LORA_PROTO_V1
+#error "BATCH frames (LORA_BATCH_SIZE > 1) need protocol v1 or v2"
+#endif
+#if LORA_BATCH_SIZE > LORA_BATCH_MAX_READINGS
+#error "LORA_BATCH_SIZE must not exceed LORA_BATCH_MAX_READINGS"
+#endif
+#if LORA_MEASURE_FRAMES && (LORA_PROTOCOL_VERSION < LORA_PROTO_V1 || LORA_BATCH_SIZE > 1)
+#error "MEASURE frames (LORA_MEASURE_FRAMES) need protocol v1 or v2 and LORA_BATCH_SIZE 1"
+#endif
+// A PARITY frame follows every LORA_FEC_GROUP DATA frames
+#define LORA_FEC (LORA_FEC_GROUP > 1)
+#if LORA_FEC && (LORA_PROTOCOL_VERSION < LORA_PROTO_V1 || LORA_BATCH_SIZE > 1 || LORA_FEC_GROUP > LORA_FEC_MAX_GROUP)
+#error "LORA_FEC_GROUP needs protocol v1 or v2, LORA_BATCH_SIZE 1 and at most LORA_FEC_MAX_GROUP frames"
+#endif
+#if LORA_TDMA && LORA_PROTOCOL_VERSION < LORA_PROTO_V1
+#error "TDMA beacons (LORA_TDMA) need protocol v1 or v2"
+#endif
+#if LORA_PROTOCOL_VERSION == LORA_PROTO_V2 && LORA_TAG_LEN > SIPHASH_OUTPUT_LEN
+#error "SipHash-2-4 (protocol v2) produces 8-byte tags: LORA_TAG_LEN must be 4 or 8"
+#endif
 
 // --- CONFIGURATION ---
 const int LED_PIN = 13;
 const int LORA_BAUD_RATE = 9600;
 
-// --- UTILS ---
+// MAC keys of LORA_SHARED_SECRET (HMAC midstates + SipHash key), computed once in loraTask()
+static MacKey loraKey;
+static const MacAlgorithm LORA_MAC = loraMacForVersion(LORA_PROTOCOL_VERSION);
 
-static String byteToHexString(uint8_t b) {
-    String s = String(b, HEX);
-    if (s.length() < 2) s = "0" + s;
-    return s;
-}
+static LoRaModem loraModem;
 
-static void sendAT(String cmd) {
-    Serial1.print(cmd + "\r\n");
-}
+// Réglage radio courant (SF + pas de puissance), annoncé dans chaque trame DATA.
+// Repris du bloc conservé après un reset de réveil (voir saveRetained).
+static uint8_t adrCurrent = LORA_ADR_DEFAULT;
 
-static String readResponse(uint16_t timeout = 2000) {
-    String s = "";
-    uint32_t t0 = millis();
-    while (millis() - t0 < timeout) {
-        while (Serial1.available()) {
-            s += (char)Serial1.read();
-        }
-        delay(10);
-    }
-    return s;
-}
+// --- UTILS ---
 
 static bool initLoRaModule() {
-    Serial.println("[LoRa] Initialisation du module...");
-    Serial1.begin(LORA_BAUD_RATE);
+    LOG_INFO("Initialisation du module...");
+    if (!loraModem.begin(LORA_BAUD_RATE)) {
+        LOG_ERROR("Echec démarrage du driver modem.");
+        return false;
+    }
     
     // Retry Loop
     for (int i = 0; i < 3; i++) {
-        while(Serial1.available()) Serial1.read(); // Clear buffer
-        
-        sendAT("AT");
-        String resp = readResponse(1000);
-        
-        if (resp.indexOf("OK") != -1) {
-             Serial.println("[LoRa] Module OK.");
-             // Config
-             sendAT("AT+MODE=TEST"); delay(100); readResponse();
-             sendAT("AT+TEST=RFCFG,868,SF7,125,12,15,14"); delay(100); readResponse();
-             return true;
+        if (loraModem.command("AT", "+AT: OK") == MODEM_OK) {
+             LOG_INFO("Module OK.");
+             // Config: chaque commande rend la main dès la réponse du module
+             if (loraModem.command("AT+MODE=TEST", "+MODE: TEST") == MODEM_OK &&
+                 loraModem.configure(loraAdrSf(adrCurrent), loraAdrPowerDbm(adrCurrent)) == MODEM_OK) {
+                 return true;
+             }
+             LOG_ERROR("Erreur de configuration.");
+        } else {
+             LOG_WARN("Pas de réponse... Retry.");
         }
-        Serial.println("[LoRa] Pas de réponse... Retry.");
-        delay(500);
+        vTaskDelay(500 / portTICK_PERIOD_MS);
     }
-    Serial.println("[LoRa] Echec connexion module.");
+    LOG_ERROR("Echec connexion module.");
     return false;
 }
 
+// --- CHANNEL ACCESS ---
+#if LORA_LBT
+// Compteurs de ce réveil, affichés (puis remis à zéro) avant la veille
+struct ChannelStats {
+    uint32_t clear;       // Emissions sur canal libre dès la première mesure
+    uint32_t busy;        // Mesures au-dessus de LORA_LBT_THRESHOLD_DBM
+    uint32_t backoffMs;   // Temps total passé en backoff
+    uint32_t forced;      // Emissions sur canal encore occupé
+    uint32_t collisions;  // ACK perdus (collision probable)
+};
+static ChannelStats channelStats = {};
+static uint8_t backoffExponent = 0; // +1 par canal occupé / ACK perdu, 0 après un ACK
+static bool lbtAvailable = true;
+
+// Attente aléatoire dans [0, LORA_LBT_BACKOFF_MS << exposant)
+static void channelBackoff() {
+    uint32_t window = (uint32_t)LORA_LBT_BACKOFF_MS << backoffExponent;
+    if (backoffExponent < LORA_LBT_MAX_EXPONENT) backoffExponent++;
+    uint32_t waitMs = random(window);
+    channelStats.backoffMs += waitMs;
+    LOG_DEBUG("Backoff %lu ms (fenêtre %lu ms).", waitMs, window);
+    vTaskDelay(pdMS_TO_TICKS(waitMs));
+}
+
+static bool channelClear() {
+    if (!lbtAvailable) return true;
+    int rssi;
+    ModemResult result = loraModem.channelRssi(&rssi);
+    if (result == MODEM_ERROR) {
+        LOG_WARN("LBT: AT+TEST=RSSI refusé, émission sans écoute.");
+        lbtAvailable = false;
+        return true;
+    }
+    if (result != MODEM_OK || rssi <= LORA_LBT_THRESHOLD_DBM) return true; // Mesure perdue: pas d'attente
+    channelStats.busy++;
+    LOG_DEBUG("LBT: canal occupé (%d dBm).", rssi);
+    return false;
+}
+
+// Ecoute avant émission: backoff tant que le canal est occupé, au plus
+// LORA_LBT_MAX_BACKOFFS fois, puis émission quand même (seuil mal réglé,
+// brouilleur permanent...)
+static void acquireChannel() {
+    for (uint8_t i = 0; ; i++) {
+        if (channelClear()) {
+            if (i == 0) channelStats.clear++;
+            return;
+        }
+        if (i == LORA_LBT_MAX_BACKOFFS) break;
+        channelBackoff();
+    }
+    channelStats.forced++;
+    LOG_WARN("LBT: canal toujours occupé, émission forcée.");
+}
+
+static void channelOnAck(bool received) {
+    if (received) backoffExponent = 0;
+    else channelStats.collisions++;
+}
+
+static void logChannelStats() {
+    LOG_INFO("LBT: %lu libre(s), %lu occupé(s), %lu ms de backoff, %lu forcée(s), %lu ACK perdu(s).",
+             channelStats.clear, channelStats.busy, channelStats.backoffMs, channelStats.forced,
+             channelStats.collisions);
+    channelStats = {};
+}
+#else
+static void acquireChannel() {}
+static void channelOnAck(bool) {}
+static void logChannelStats() {}
+#endif
+
+// --- AIRTIME ---
+// Budget EU868 de 1 % sur l'heure glissante, veille comprise (uptimeMs). Repris
+// du bloc conservé après un reset de réveil.
+static AirtimeWindow airtime = {};
+static uint32_t txRefused = 0;
+
+static void logRadioStats() {
+    logChannelStats();
+    uint32_t hourUs = airtime_window_us(&airtime, SleepManager::uptimeMs());
+    uint16_t dutyCp = airtime_duty_cycle_cp(hourUs);
+    LOG_INFO("Airtime: %lu ms sur l'heure (%u.%02u %%), %lu émission(s) refusée(s).", hourUs / 1000, dutyCp / 100,
+             dutyCp % 100, txRefused);
+}
+
 // --- LORA LOGIC ---
 
+// Builds [HDR, ID, TYPE] (v1) or [ID, TYPE] (legacy) + body + tag. flags =
+// LORA_HDR_* (v1/v2 only). Returns the frame length; *tag points to the tag
+// inside the frame.
+static size_t buildFrame(uint8_t type, const uint8_t *body, size_t bodyLen, uint8_t *frame, const uint8_t **tag,
+                         uint8_t flags = 0) {
+    size_t len = 0;
+#if LORA_PROTOCOL_VERSION >= LORA_PROTO_V1
+    const size_t tagLen = LORA_TAG_LEN;
+    frame[len++] = loraMakeHeader(LORA_PROTOCOL_VERSION, LORA_TAG_LEN, flags);
+#else
+    const size_t tagLen = LORA_FULL_TAG_LEN;
+#endif
+    frame[len++] = SENSOR_ID;
+    frame[len++] = type;
+    memcpy(frame + len, body, bodyLen);
+    len += bodyLen;
+
+    uint8_t fullTag[32];
+    mac_compute(LORA_MAC, &loraKey, frame, len, fullTag);
+    memcpy(frame + len, fullTag, tagLen);
+    *tag = frame + len;
+    return len + tagLen;
+}
+
+static uint32_t lastTxDoneMs = 0; // Fin de la dernière émission (aller-retour de l'ACK)
+
+// Sends a frame, returns once the modem reports "TX DONE", then switches to RX
+// for the reply (listen = false: no reply expected, the radio stays idle)
+// Refused (false) if its time on air would exceed the duty-cycle budget
+static bool transmitFrame(const uint8_t *frame, size_t len, bool listen = true) {
+    uint32_t toaUs = loraModem.timeOnAirUs(len);
+    if (!airtime_window_allows(&airtime, SleepManager::uptimeMs(), toaUs)) {
+        txRefused++;
+        LOG_WARN("Duty cycle: émission de %lu us refusée (%lu ms sur l'heure).", toaUs,
+                 airtime_window_us(&airtime, SleepManager::uptimeMs()) / 1000);
+        return false;
+    }
+
+    acquireChannel();
+    loraModem.flushReceived();
+    ModemResult result = loraModem.transmit(frame, len, loraModem.txTimeoutMs(len));
+    // Un timeout peut cacher une émission: comptée quand même
+    if (result == MODEM_OK || result == MODEM_TIMEOUT) airtime_window_add(&airtime, SleepManager::uptimeMs(), toaUs);
+    if (result != MODEM_OK) return false;
+    lastTxDoneMs = millis();
+    return !listen || loraModem.startReceive() == MODEM_OK;
+}
+
+#if LORA_PROTOCOL_VERSION >= LORA_PROTO_V1
+// Checks a v1/v2 reply: [HDR, ID, TYPE, body...] + TAG = MAC(reply || request tag)
+static bool verifyReply(const LoraFrameView &reply, const uint8_t *frame, const uint8_t *requestTag) {
+    if (reply.version != LORA_PROTOCOL_VERSION || reply.tagLen != LORA_TAG_LEN || reply.nodeId != SENSOR_ID) return false;
+
+    uint8_t fullTag[32];
+    MacContext mac;
+    mac_init(&mac, LORA_MAC, &loraKey);
+    mac_update(&mac, frame, reply.signedLen);
+    mac_update(&mac, requestTag, LORA_TAG_LEN);
+    mac_final(&mac, fullTag);
+    return constant_time_equal(reply.tag, fullTag, reply.tagLen);
+}
+#endif
+
+#if LORA_PROTOCOL_VERSION >= LORA_PROTO_V1 && LORA_EXPECTS_ACK
+// --- ADR ---
+static uint8_t adrPending = LORA_ADR_NONE;
+static uint8_t adrPendingCount = 0;
+static uint8_t adrLosses = 0;
+
+static void adrApply(uint8_t adr) {
+    if (loraModem.configure(loraAdrSf(adr), loraAdrPowerDbm(adr)) != MODEM_OK) {
+        LOG_ERROR("ADR: RFCFG refusé.");
+        return;
+    }
+    LOG_INFO("ADR: SF%u / %d dBm (avant SF%u / %d dBm).", loraAdrSf(adr), loraAdrPowerDbm(adr),
+             loraAdrSf(adrCurrent), loraAdrPowerDbm(adrCurrent));
+    adrCurrent = adr;
+}
+
+// Recommandation reçue dans un ACK. Le SF suit la passerelle tout de suite (elle
+// n'écoute que celui-là), une hausse de puissance aussi; une baisse de puissance
+// attend LORA_ADR_HYSTERESIS ACK consécutifs qui la demandent.
+static void adrOnAck(uint8_t recommended) {
+    adrLosses = 0;
+    if (!loraAdrValid(recommended) || recommended == adrCurrent) {
+        adrPendingCount = 0;
+        return;
+    }
+    bool urgent = loraAdrSf(recommended) != loraAdrSf(adrCurrent) ||
+                  loraAdrPowerStep(recommended) < loraAdrPowerStep(adrCurrent);
+    if (!urgent) {
+        if (recommended != adrPending) {
+            adrPending = recommended;
+            adrPendingCount = 0;
+        }
+        if (++adrPendingCount < LORA_ADR_HYSTERESIS) return;
+    }
+    adrPendingCount = 0;
+    adrApply(recommended);
+}
+
+// Pas d'ACK: après LORA_ADR_FALLBACK_LOSSES échanges perdus, retour au réglage
+// par défaut (celui sur lequel la passerelle se replie aussi)
+static void adrOnAckLost() {
+    adrPendingCount = 0;
+    if (++adrLosses < LORA_ADR_FALLBACK_LOSSES || adrCurrent == LORA_ADR_DEFAULT) return;
+    LOG_WARN("ADR: %u ACK perdus, retour au réglage par défaut.", adrLosses);
+    adrLosses = 0;
+    adrApply(LORA_ADR_DEFAULT);
+}
+#endif
+
+#if !LORA_ACK_SYNC
 // Request Time from Receiver
-// Packet: [ID, TYPE=3, 0,0,0,0 (Padding), HMAC]
+// Packet: [ID, TYPE=3, 0,0,0,0 (Padding), HMAC] (legacy)
+//         [HDR, ID, TYPE=3, NONCE(4)] + TAG    (v1/v2, the response is bound to the nonce)
 static bool requestTimeSync() {
-    Serial.println("[LoRa] Requesting Time Sync...");
+    LOG_INFO("Requesting Time Sync...");
     
-    // 1. Prepare Data
-    uint8_t payload[6]; 
-    payload[0] = SENSOR_ID;
-    payload[1] = 3; // Type 3 = Time Request
-    memset(&payload[2], 0, 4); // Padding
-
-    // 2. Sign Data (HMAC)
-    uint8_t hmac[32];
-    hmac_sha256((const uint8_t*)LORA_SHARED_SECRET, strlen(LORA_SHARED_SECRET), payload, 6, hmac);
-
-    // 3. Build Hex String
-    String hexPayload = "";
-    for(int i=0; i<6; i++) hexPayload += byteToHexString(payload[i]);
-    for(int i=0; i<32; i++) hexPayload += byteToHexString(hmac[i]);
-
-    // 4. Send
-    while(Serial1.available()) Serial1.read();
-    sendAT("AT+TEST=TXLRPKT,\"" + hexPayload + "\"");
-
-    // 5. Wait TX DONE
+    // 1. Prepare & Sign Data
+    uint8_t body[LORA_TIME_BODY_LEN];
+#if LORA_PROTOCOL_VERSION >= LORA_PROTO_V1
+    RTCTime current;
+    RTC.getTime(current);
+    uint32_t nonce = (uint32_t)random(0x7FFFFFFF) ^ current.getUnixTime() ^ (micros() << 8);
+    memcpy(body, &nonce, sizeof(body));
+#else
+    memset(body, 0, sizeof(body)); // Padding
+#endif
+    uint8_t frame[LORA_MAX_FRAME_LEN];
+    const uint8_t *tag;
+    size_t frameLen = buildFrame(LORA_MSG_TIME_REQ, body, sizeof(body), frame, &tag);
+
+    // 2. Send & Wait TX DONE
+    if (!transmitFrame(frame, frameLen)) { LOG_ERROR("TX Error during sync."); return false; }
+
+    // 3. Wait for Response (Type 4)
+    LOG_INFO("Waiting for Time Response...");
+    LoraRxPacket rx;
     uint32_t tStart = millis();
-    bool txDone = false;
-    while(millis() - tStart < 3000) {
-        String line = Serial1.readStringUntil('\n');
-        if (line.indexOf("TX DONE") != -1) {
-            txDone = true; break;
-        }
-    }
-    if(!txDone) { Serial.println("[LoRa] TX Error during sync."); return false; }
+    while (millis() - tStart < 3000) { // Reduced timeout to 3s to be less blocking
+        if (!loraModem.receive(&rx, 3000 - (millis() - tStart))) break;
 
-    // 6. Wait for Response (Type 4)
-    Serial.println("[LoRa] Waiting for Time Response...");
-    sendAT("AT+TEST=RXLRPKT");
-    
-    String rxBuffer = "";
-    tStart = millis();
-    while(millis() - tStart < 3000) { // Reduced timeout to 3s to be less blocking
-        while(Serial1.available()) {
-            char c = Serial1.read();
-            rxBuffer += c;
-            if (c == '\n') {
-                if (rxBuffer.indexOf("+TEST: RX \"") != -1) {
-                    int first = rxBuffer.indexOf('"');
-                    int last = rxBuffer.lastIndexOf('"');
-                    if(first != -1 && last > first) {
-                        String hexContent = rxBuffer.substring(first+1, last);
-                        if(hexContent.length() == 76) {
-                            // Decode (Simplified for sync check)
-                            uint8_t packet[38];
-                            for(int i=0; i<38; i++) {
-                                String b = hexContent.substring(i*2, i*2+2);
-                                packet[i] = (uint8_t)strtol(b.c_str(), NULL, 16);
-                            }
-                            
-                            // Check Type
-                            if(packet[1] == 4) { // Time Response
-                                uint32_t receivedTime = packet[2] | (packet[3] << 8) | (packet[4] << 16) | (packet[5] << 24);
-                                Serial.print("[LoRa] Time Sync Success! Unix Time: ");
-                                Serial.println(receivedTime);
-                                
-                                RTCTime timeToSet(receivedTime);
-                                RTC.setTime(timeToSet);
-                                return true; 
-                            }
-                        }
-                    }
-                }
-                rxBuffer = "";
-            }
+        LoraFrameView view;
+        if (!loraParseFrame(rx.frame, rx.len, &view)) continue;
+        if (view.type != LORA_MSG_TIME_RESP || view.bodyLen != LORA_TIME_BODY_LEN) continue;
+#if LORA_PROTOCOL_VERSION >= LORA_PROTO_V1
+        if (!verifyReply(view, rx.frame, tag)) {
+            LOG_WARN("Time Response rejected (bad tag).");
+            continue;
         }
+#endif
+        uint32_t receivedTime = LoraTimeBody::Time::get(view.body);
+        LOG_INFO("Time Sync Success! Unix Time: %lu", receivedTime);
+        
+        RTCTime timeToSet(receivedTime);
+        RTC.setTime(timeToSet);
+        return true; 
     }
-    Serial.println("[LoRa] Time Sync Failed (Timeout).");
+    LOG_WARN("Time Sync Failed (Timeout).");
     return false;
 }
+#endif
 
-// Send Packet: [ID, Type, Seq, T_low, T_high, H_low, H_high] + [HMAC(32)]
-static bool sendSecurePacket(float temp, float hum) {
-    static uint8_t sequenceCounter = 0;
-    
-    // 1. Prepare Data
-    uint8_t payload[7]; 
-    
-    // Valeur magique 0x7FFF si le capteur est en erreur (NAN)
-    int16_t tInt = isnan(temp) ? 0x7FFF : (int16_t)(temp * 100);
-    int16_t hInt = isnan(hum) ? 0x7FFF : (int16_t)(hum * 100);
-
-    payload[0] = SENSOR_ID;
-    payload[1] = 2; // Type 2 = Mixed
-    payload[2] = sequenceCounter++;
-    payload[3] = (uint8_t)(tInt & 0xFF);
-    payload[4] = (uint8_t)((tInt >> 8) & 0xFF);
-    payload[5] = (uint8_t)(hInt & 0xFF);
-    payload[6] = (uint8_t)((hInt >> 8) & 0xFF);
-
-    // 2. Sign Data (HMAC)
-    uint8_t hmac[32];
-    hmac_sha256((const uint8_t*)LORA_SHARED_SECRET, strlen(LORA_SHARED_SECRET), payload, 7, hmac);
-
-    // 3. Build Hex String
-    String hexPayload = "";
-    for(int i=0; i<7; i++) hexPayload += byteToHexString(payload[i]);
-    for(int i=0; i<32; i++) hexPayload += byteToHexString(hmac[i]);
-
-    String sentHashStr = hashToString(hmac);
-    sentHashStr.toUpperCase();
-
-    Serial.println("[LoRa] Sending Packet with Hash: " + sentHashStr);
-
-    // 4. Send AT Command
-    // Flush Rx buffer first
-    while(Serial1.available()) Serial1.read();
-    
-    sendAT("AT+TEST=TXLRPKT,\"" + hexPayload + "\"");
+#if LORA_TDMA
+// --- TDMA ---
+// Le beacon remplace l'échange TIME_REQ/TIME_RESP: il donne l'heure, notre
+// créneau et l'ACK groupé de la trame du cycle précédent.
+struct TdmaSchedule {
+    bool valid;
+    uint32_t beaconTime;  // Heure Unix annoncée par le dernier beacon
+    uint16_t periodSec;   // Supertrame: le beacon suivant arrive à beaconTime + periodSec
+    uint32_t slotStartMs; // millis() du début de notre créneau
+};
+static TdmaSchedule tdma = { false, 0, 0, 0 };
+static MacKey beaconKey;
 
-    // 5. Wait for TX DONE
+// Ecoute jusqu'au premier beacon authentique (au plus LORA_BEACON_LISTEN_SEC),
+// règle le RTC et calcule notre créneau. Sans créneau attribué: un créneau de
+// la fenêtre d'accès libre au hasard, la passerelle nous inscrit à la réception.
+static bool waitForBeacon() {
+    LOG_INFO("Waiting for Beacon...");
+    tdma.valid = false; // Créneau précédent périmé (millis() arrêté pendant la veille)
+    if (loraModem.startReceive() != MODEM_OK) return false;
+
+    LoraRxPacket rx;
+    const uint32_t timeoutMs = LORA_BEACON_LISTEN_SEC * 1000UL;
     uint32_t tStart = millis();
-    bool txDone = false;
-    while(millis() - tStart < 3000) {
-        String line = Serial1.readStringUntil('\n');
-        line.trim();
-        if (line.indexOf("TX DONE") != -1) {
-            txDone = true;
-            break;
+    while (millis() - tStart < timeoutMs) {
+        if (!loraModem.receive(&rx, timeoutMs - (millis() - tStart))) break;
+        uint32_t rxMs = millis() - (micros() - rx.timestampUs) / 1000; // Fin de la ligne "+TEST: RX"
+
+        LoraFrameView view;
+        if (!loraParseFrame(rx.frame, rx.len, &view) || view.type != LORA_MSG_BEACON ||
+            view.nodeId != LORA_GATEWAY_ID || view.version != LORA_PROTOCOL_VERSION) {
+            continue;
+        }
+        uint8_t fullTag[32];
+        mac_compute(LORA_MAC, &beaconKey, rx.frame, view.signedLen, fullTag);
+        LoraBeacon beacon;
+        if (!constant_time_equal(view.tag, fullTag, view.tagLen) || !loraParseBeacon(view.body, view.bodyLen, &beacon)) {
+            LOG_WARN("Beacon rejected (bad tag or format).");
+            continue;
+        }
+
+        RTCTime timeToSet(beacon.time);
+        RTC.setTime(timeToSet);
+
+        int slot = loraBeaconSlot(beacon, SENSOR_ID);
+        if (slot >= 0) {
+            LOG_INFO("Beacon: %lu, créneau %d/%u, trame précédente %s.", beacon.time, slot, beacon.count,
+                     loraBeaconAcked(beacon, slot) ? "acquittée" : "non acquittée");
+        } else {
+            slot = beacon.count + random(LORA_BEACON_JOIN_SLOTS);
+            LOG_INFO("Beacon: %lu, pas de créneau, accès libre en %d.", beacon.time, slot);
         }
+        tdma.valid = true;
+        tdma.beaconTime = beacon.time;
+        tdma.periodSec = beacon.periodSec;
+        tdma.slotStartMs = rxMs + (uint32_t)slot * beacon.slotMs;
+        return true;
     }
+    LOG_WARN("No Beacon, free access.");
+    return false;
+}
 
-    if (!txDone) {
-        Serial.println("[LoRa] Error: TX Timeout.");
+// Attend le début de notre créneau; false s'il est déjà passé (lecture prête trop tard)
+static bool waitForSlot() {
+    int32_t wait = (int32_t)(tdma.slotStartMs - millis());
+    if (wait < 0) {
+        LOG_WARN("Créneau manqué de %ld ms.", (long)-wait);
         return false;
     }
+    vTaskDelay(pdMS_TO_TICKS(wait));
+    return true;
+}
+#endif
 
-    // 6. Wait for ACK (TCP-like handshake)
-    // The receiver should send back the HMAC we just sent.
-    Serial.println("[LoRa] TX Done. Waiting for ACK...");
-    
-    sendAT("AT+TEST=RXLRPKT"); // Switch to RX mode
+static uint8_t sequenceCounter = 0;
+
+#if LORA_PROTOCOL_VERSION >= LORA_PROTO_V1 && LORA_EXPECTS_ACK
+// Heure de la passerelle dans l'ACK cumulatif: [TIME(4), MS(2)] pris quand
+// l'ACK a été construit, soit à peu près au milieu de l'aller-retour entre
+// notre TX DONE et la réception de l'ACK (rxUs, horodatage ISR). Le RTC ne
+// garde que la seconde: arrondi à la plus proche.
+static void syncFromAck(const uint8_t *body, uint32_t rxUs) {
+    uint32_t sec = LoraCumAckBody::Time::get(body);
+    uint16_t ms = LoraCumAckBody::Ms::get(body);
+    if (ms > 999) return;
+
+    uint32_t sinceRx = (micros() - rxUs) / 1000;
+    uint32_t roundTrip = millis() - sinceRx - lastTxDoneMs;
+    uint32_t nowMs = ms + roundTrip / 2 + sinceRx; // Millisecondes écoulées depuis `sec`
+    RTCTime timeToSet(sec + (nowMs + 500) / 1000);
+    RTC.setTime(timeToSet);
+    setTimeSyncStatus(true);
+    LOG_INFO("Heure de l'ACK: %lu.%03u, aller-retour %lu ms.", sec, ms, roundTrip);
+}
+#endif
+
+#if LORA_EXPECTS_ACK
+// Waits for the ACK of the frame just sent (TCP-like handshake) and returns
+// what it confirms as a cumulative ACK (*cum, *map).
+// Legacy: the receiver sends back the HMAC we just sent.
+// v1/v2: [HDR, ID, ACK, CUM, MAP(2), ADR, TIME(4), MS(2)] + TAG = MAC(ack || our tag),
+// same tag length ([SEQ, ADR] for frames sent without LORA_HDR_CUM_ACK).
+static bool waitForAck(uint8_t sequence, const uint8_t *tag, uint8_t *cum, uint16_t *map) {
+    LOG_INFO("TX Done. Waiting for ACK...");
     
-    tStart = millis();
-    bool ackReceived = false;
-    String ackBuffer = "";
+    LoraRxPacket rx;
+    uint32_t tStart = millis();
+    *cum = sequence;
+    *map = 0;
 
     // Wait up to 5 seconds for ACK
-    while(millis() - tStart < 5000) {
-        if (Serial1.available()) {
-            char c = Serial1.read();
-            if (c == '\n') {
-                if (ackBuffer.indexOf("+TEST: RX \"") != -1) {
-                    // Extract Content
-                    int firstQuote = ackBuffer.indexOf('"');
-                    int lastQuote = ackBuffer.lastIndexOf('"');
-                    if (firstQuote != -1 && lastQuote > firstQuote) {
-                        String content = ackBuffer.substring(firstQuote + 1, lastQuote);
-                        content.toUpperCase();
-                        // Check if the received content contains our Hash
-                        if (content.indexOf(sentHashStr) != -1) {
-                            ackReceived = true;
-                            Serial.println("[LoRa] Valid ACK received !");
-                            break;
-                        } else {
-                             Serial.println("[LoRa] Received packet but hash mismatch (Duplicate or other source).");
-                        }
-                    }
-                }
-                ackBuffer = "";
-            } else {
-                ackBuffer += c;
+    while (millis() - tStart < 5000) {
+        if (!loraModem.receive(&rx, 5000 - (millis() - tStart))) break;
+
+#if LORA_PROTOCOL_VERSION >= LORA_PROTO_V1
+        LoraFrameView ack;
+        if (loraParseFrame(rx.frame, rx.len, &ack) && ack.type == LORA_MSG_ACK && verifyReply(ack, rx.frame, tag)) {
+            if (ack.bodyLen == LORA_ACK_CUM_BODY_LEN || ack.bodyLen == LORA_ACK_TIME_BODY_LEN) {
+                if (ack.bodyLen == LORA_ACK_TIME_BODY_LEN) syncFromAck(ack.body, rx.timestampUs);
+                *cum = LoraCumAckBody::Cum::get(ack.body);
+                *map = LoraCumAckBody::Map::get(ack.body);
+                LOG_INFO("Valid ACK received ! (cumul %u, map %04x)", *cum, *map);
+                adrOnAck(LoraCumAckBody::Adr::get(ack.body));
+                channelOnAck(true);
+                return true;
+            }
+            if ((ack.bodyLen == LORA_ACK_BODY_LEN || ack.bodyLen == LORA_ACK_ADR_BODY_LEN) &&
+                LoraAckBody::Seq::get(ack.body) == sequence) {
+                LOG_INFO("Valid ACK received !");
+                adrOnAck(ack.bodyLen == LORA_ACK_ADR_BODY_LEN ? LoraAckBody::Adr::get(ack.body) : LORA_ADR_NONE);
+                channelOnAck(true);
+                return true;
             }
         }
+#else
+        bool valid = rx.len == LORA_FULL_TAG_LEN && constant_time_equal(rx.frame, tag, LORA_FULL_TAG_LEN);
+        if (valid) {
+            LOG_INFO("Valid ACK received !");
+            channelOnAck(true);
+            return true;
+        }
+#endif
+        LOG_WARN("Received packet but ACK mismatch (Duplicate or other source).");
+    }
+
+#if LORA_PROTOCOL_VERSION >= LORA_PROTO_V1
+    adrOnAckLost();
+#endif
+    channelOnAck(false);
+    return false;
+}
+
+// Après un échange raté (ACK perdu, collision probable): true s'il reste un
+// essai, après un backoff aléatoire. En TDMA le créneau est passé: pas d'essai.
+static bool retryExchange(uint8_t attempt) {
+#if LORA_TDMA
+    if (tdma.valid) return false;
+#endif
+#if LORA_LBT
+    if (attempt >= LORA_LBT_MAX_RETRIES) return false;
+    LOG_WARN("Nouvel essai %u/%u après backoff.", attempt + 1, LORA_LBT_MAX_RETRIES);
+    channelBackoff();
+    return true;
+#else
+    (void)attempt;
+    return false;
+#endif
+}
+#endif
+
+// Valeur magique LORA_SENSOR_ERROR si le capteur est en erreur (NAN)
+static int16_t toCenti(float value) {
+    return isnan(value) ? LORA_SENSOR_ERROR : (int16_t)(value * 100);
+}
+
+#if LORA_BATCH_SIZE <= 1
+struct SentReading {
+    uint8_t sequence;
+    uint8_t retries;
+    int16_t temperature;
+    int16_t humidity;
+#if LORA_MEASURE_FRAMES
+    uint32_t time;        // 0 = heure inconnue
+    uint16_t batteryMv;   // 0 = pas de mesure
+    uint16_t status;      // LORA_STATUS_*
+#endif
+};
+
+#if LORA_MEASURE_FRAMES
+// Pont diviseur sur SENSOR_VBAT_PIN, ADC 10 bits référencé sur 5 V
+static uint16_t readBatteryMv() {
+#if SENSOR_VBAT
+    uint32_t raw = analogRead(SENSOR_VBAT_PIN);
+    return (uint16_t)(raw * 5000UL * SENSOR_VBAT_DIVIDER / 1023);
+#else
+    return 0;
+#endif
+}
+
+// Contexte de la lecture, figé avec elle (une retransmission renvoie les mêmes octets)
+static void describeReading(SentReading *r) {
+    r->status = 0;
+    if (r->temperature != LORA_SENSOR_ERROR) r->status |= LORA_STATUS_SENSOR_OK;
+    if (isTimeSynced()) {
+        r->status |= LORA_STATUS_TIME_SYNCED;
+        RTCTime current;
+        RTC.getTime(current);
+        r->time = current.getUnixTime();
+    } else {
+        r->time = 0;
     }
+#if LORA_TDMA
+    if (tdma.valid) r->status |= LORA_STATUS_TDMA;
+#endif
+    r->batteryMv = readBatteryMv();
+}
 
-    return ackReceived;
+// Packet MEASURE: [HDR, ID, Type=9, Seq, ADR, records...] + [TAG(N)]
+// Un canal sans valeur (capteur en erreur, pas d'heure) n'est pas envoyé.
+static size_t buildMeasureBody(const SentReading &r, uint8_t *body, size_t cap) {
+    LoraPrefixBody::Seq::put(body, r.sequence);
+    LoraPrefixBody::Adr::put(body, adrCurrent);
+    LoraTlvWriter w;
+    lora_tlv_init(&w, body + LORA_MEASURE_PREFIX_LEN, cap - LORA_MEASURE_PREFIX_LEN);
+    if (r.temperature != LORA_SENSOR_ERROR) lora_tlv_put_u16(&w, LORA_TLV_TEMPERATURE, (uint16_t)r.temperature);
+    if (r.humidity != LORA_SENSOR_ERROR) lora_tlv_put_u16(&w, LORA_TLV_HUMIDITY, (uint16_t)r.humidity);
+    if (r.time != 0) lora_tlv_put_u32(&w, LORA_TLV_TIME, r.time);
+    if (r.batteryMv != 0) lora_tlv_put_u16(&w, LORA_TLV_BATTERY, r.batteryMv);
+    lora_tlv_put_u16(&w, LORA_TLV_STATUS, r.status);
+    return LORA_MEASURE_PREFIX_LEN + w.len;
+}
+#endif
+
+// Packet: [ID, Type, Seq, T_low, T_high, H_low, H_high] + [HMAC(32)]        (legacy)
+//         [HDR, ID, Type, Seq, T_low, T_high, H_low, H_high, ADR] + [TAG(N)] (v1/v2)
+// Sends one DATA (or MEASURE) frame; listens for the reply only if `flags` asks for one.
+static bool transmitData(const SentReading &r, uint8_t flags, uint8_t *frame, const uint8_t **tag) {
+#if LORA_MEASURE_FRAMES
+    uint8_t body[LORA_MAX_FRAME_LEN - 3 - LORA_TAG_LEN];
+    size_t frameLen = buildFrame(LORA_MSG_MEASURE, body, buildMeasureBody(r, body, sizeof(body)), frame, tag, flags);
+    LOG_INFO("Sending Measure seq %u (%u octets)", r.sequence, frameLen);
+#else
+#if LORA_PROTOCOL_VERSION >= LORA_PROTO_V1
+    uint8_t body[LORA_DATA_ADR_BODY_LEN];
+    LoraDataBody::Adr::put(body, adrCurrent); // Réglage radio de cette trame (mesure de marge côté passerelle)
+#else
+    uint8_t body[LORA_DATA_BODY_LEN];
+#endif
+    LoraDataBody::Seq::put(body, r.sequence);
+    LoraDataBody::Temperature::put(body, r.temperature);
+    LoraDataBody::Humidity::put(body, r.humidity);
+
+    // Sign Data (MAC, tronqué en v1/v2)
+    size_t frameLen = buildFrame(LORA_MSG_DATA, body, sizeof(body), frame, tag, flags);
+    LOG_INFO("Sending Packet seq %u (%u octets)", r.sequence, frameLen);
+#endif
+
+    if (!transmitFrame(frame, frameLen, !(flags & LORA_HDR_NO_ACK))) {
+        LOG_ERROR("Error: TX Timeout.");
+        return false;
+    }
+    return true;
+}
+
+#if LORA_PROTOCOL_VERSION >= LORA_PROTO_V1 && LORA_ACK_MODE != LORA_ACK_NONE
+// --- RETRANSMISSION ---
+// Trames envoyées pas encore couvertes par un ACK cumulatif, la plus ancienne en
+// tête. Après un ACK, seules celles qu'il déclare manquantes repartent (sans
+// demander d'ACK: le prochain ACK dira si elles sont arrivées).
+static SentReading unconfirmed[LORA_ACK_MAP_BITS];
+static size_t unconfirmedCount = 0;
+static uint8_t framesSinceAck = 0; // LORA_ACK_NTH: trames parties depuis le dernier ACK
+
+static void rememberSent(const SentReading &r) {
+    if (unconfirmedCount == LORA_ACK_MAP_BITS) {
+        LOG_WARN("Seq %u jamais confirmée, abandonnée.", unconfirmed[0].sequence);
+        memmove(unconfirmed, unconfirmed + 1, (unconfirmedCount - 1) * sizeof(SentReading));
+        unconfirmedCount--;
+    }
+    unconfirmed[unconfirmedCount++] = r;
+}
+
+static void retransmitMissing(uint8_t cum, uint16_t map) {
+    size_t kept = 0;
+    for (size_t i = 0; i < unconfirmedCount; i++) {
+        SentReading &r = unconfirmed[i];
+        if (loraAckCovers(cum, map, r.sequence)) continue;
+        if (r.retries >= LORA_ACK_MAX_RETRIES) {
+            LOG_WARN("Seq %u perdue après %u retransmissions.", r.sequence, r.retries);
+            continue;
+        }
+        r.retries++;
+        uint8_t frame[LORA_MAX_FRAME_LEN];
+        const uint8_t *tag;
+        transmitData(r, LORA_HDR_NO_ACK, frame, &tag);
+        unconfirmed[kept++] = r;
+    }
+    unconfirmedCount = kept;
+}
+#endif
+
+#if LORA_FEC
+// --- FEC ---
+// XOR des lectures du groupe en cours; la trame PARITY (jamais acquittée) part
+// juste après la dernière trame DATA du groupe, envoyée ou non.
+static uint8_t fecFirst = 0;
+static uint8_t fecCount = 0;
+static uint8_t fecParity[LORA_FEC_PAYLOAD_LEN];
+
+static void fecAdd(const SentReading &r) {
+    if (fecCount == 0) {
+        fecFirst = r.sequence;
+        memset(fecParity, 0, sizeof(fecParity));
+    }
+    uint8_t reading[LORA_FEC_PAYLOAD_LEN];
+    LoraFecReading::Temperature::put(reading, r.temperature);
+    LoraFecReading::Humidity::put(reading, r.humidity);
+    for (size_t i = 0; i < LORA_FEC_PAYLOAD_LEN; i++) fecParity[i] ^= reading[i];
+    if (++fecCount < LORA_FEC_GROUP) return;
+    fecCount = 0;
+
+    // Parity Packet: [HDR, ID, Type=8, FIRST, K, P0, P1, P2, P3] + [TAG(N)]
+    uint8_t body[LORA_PARITY_BODY_LEN];
+    LoraParityBody::First::put(body, fecFirst);
+    LoraParityBody::Count::put(body, LORA_FEC_GROUP);
+    memcpy(body + LoraParityBody::payload, fecParity, LORA_FEC_PAYLOAD_LEN);
+    uint8_t frame[LORA_MAX_FRAME_LEN];
+    const uint8_t *tag;
+    size_t frameLen = buildFrame(LORA_MSG_PARITY, body, sizeof(body), frame, &tag, LORA_HDR_NO_ACK);
+    LOG_INFO("Sending Parity seq %u..%u (%u octets)", fecFirst, r.sequence, frameLen);
+    if (!transmitFrame(frame, frameLen, false)) LOG_ERROR("Error: TX Timeout.");
+}
+#endif
+
+// Une trame DATA par lecture. L'ACK n'est demandé que selon LORA_ACK_MODE;
+// sans ACK, pas de fenêtre de réception du tout.
+static bool exchangeData(const SentReading &r) {
+    uint8_t frame[LORA_MAX_FRAME_LEN];
+    const uint8_t *tag;
+
+#if LORA_PROTOCOL_VERSION < LORA_PROTO_V1
+    uint8_t cum;
+    uint16_t map;
+    for (uint8_t attempt = 0; ; attempt++) {
+        if (transmitData(r, 0, frame, &tag) && waitForAck(r.sequence, tag, &cum, &map)) return true;
+        if (!retryExchange(attempt)) return false;
+    }
+#elif LORA_ACK_MODE == LORA_ACK_NONE
+    return transmitData(r, LORA_HDR_NO_ACK, frame, &tag);
+#else
+    bool wantAck = (LORA_ACK_MODE == LORA_ACK_EVERY) || ++framesSinceAck >= LORA_ACK_INTERVAL;
+
+    rememberSent(r);
+    if (!wantAck) return transmitData(r, LORA_HDR_NO_ACK, frame, &tag);
+
+    // Sans ACK, framesSinceAck reste au seuil: le prochain cycle redemande
+    uint8_t cum;
+    uint16_t map;
+    for (uint8_t attempt = 0; ; attempt++) {
+        if (transmitData(r, LORA_HDR_CUM_ACK, frame, &tag) && waitForAck(r.sequence, tag, &cum, &map)) break;
+        if (!retryExchange(attempt)) return false;
+    }
+    framesSinceAck = 0;
+    retransmitMissing(cum, map);
+    return true;
+#endif
+}
+
+static bool sendSecurePacket(float temp, float hum) {
+    SentReading r = {};
+    r.sequence = sequenceCounter++;
+    r.temperature = toCenti(temp);
+    r.humidity = toCenti(hum);
+#if LORA_MEASURE_FRAMES
+    describeReading(&r);
+#endif
+    bool ok = exchangeData(r);
+#if LORA_FEC
+    fecAdd(r);
+#endif
+    return ok;
+}
+#else
+// --- BATCH ---
+// Lectures en attente, la plus ancienne en tête. Une trame BATCH part tous les
+// LORA_BATCH_SIZE cycles; sans ACK les lectures restent pour le cycle suivant,
+// buffer plein = la plus ancienne est perdue.
+static LoraReading pendingReadings[LORA_BATCH_MAX_READINGS];
+static size_t pendingCount = 0;
+
+static void queueReading(float temp, float hum) {
+    if (pendingCount == LORA_BATCH_MAX_READINGS) {
+        LOG_WARN("Batch plein, lecture la plus ancienne perdue.");
+        memmove(pendingReadings, pendingReadings + 1, (pendingCount - 1) * sizeof(LoraReading));
+        pendingCount--;
+    }
+    RTCTime current;
+    RTC.getTime(current);
+    LoraReading &r = pendingReadings[pendingCount++];
+    r.time = current.getUnixTime();
+    r.temperature = toCenti(temp);
+    r.humidity = toCenti(hum);
+}
+
+// Batch Packet: [HDR, ID, Type=6, Seq, ADR, COUNT, TIME0, T0, H0, deltas...] + [TAG(N)]
+static bool sendBatch() {
+    uint8_t body[LORA_MAX_FRAME_LEN - 3 - LORA_TAG_LEN];
+    uint8_t sequence = sequenceCounter++;
+    LoraPrefixBody::Seq::put(body, sequence);
+    LoraPrefixBody::Adr::put(body, adrCurrent);
+
+    size_t encoded;
+    size_t bodyLen = LORA_BATCH_PREFIX_LEN + lora_batch_encode(pendingReadings, pendingCount, body + LORA_BATCH_PREFIX_LEN,
+                                                               sizeof(body) - LORA_BATCH_PREFIX_LEN, &encoded);
+
+    uint8_t frame[LORA_MAX_FRAME_LEN];
+    const uint8_t *tag;
+    size_t frameLen = buildFrame(LORA_MSG_BATCH, body, bodyLen, frame, &tag, LORA_HDR_CUM_ACK);
+
+    LOG_INFO("Sending Batch: %u lectures (%u octets)", encoded, frameLen);
+
+    uint8_t cum;
+    uint16_t map;
+    for (uint8_t attempt = 0; ; attempt++) {
+        if (!transmitFrame(frame, frameLen)) LOG_ERROR("Error: TX Timeout.");
+        else if (waitForAck(sequence, tag, &cum, &map)) break;
+        if (!retryExchange(attempt)) return false;
+    }
+
+    // Acquittées: on retire celles qui étaient dans la trame
+    pendingCount -= encoded;
+    memmove(pendingReadings, pendingReadings + encoded, pendingCount * sizeof(LoraReading));
+    return true;
+}
+#endif
+
+// Une lecture par cycle: trame DATA directe, ou mise en attente jusqu'à
+// LORA_BATCH_SIZE lectures envoyées dans une seule trame BATCH
+static bool sendReading(float temp, float hum) {
+#if LORA_BATCH_SIZE > 1
+    queueReading(temp, hum);
+    if (pendingCount < LORA_BATCH_SIZE) {
+        LOG_INFO("Lecture %u/%u mise en attente.", pendingCount, LORA_BATCH_SIZE);
+        return true;
+    }
+    return sendBatch();
+#else
+    return sendSecurePacket(temp, hum);
+#endif
+}
+
+// En TDMA la trame attend notre créneau, sinon elle part tout de suite
+static bool transmitReading(float temp, float hum) {
+#if LORA_TDMA
+    if (tdma.valid && !waitForSlot()) return false;
+#endif
+    return sendReading(temp, hum);
+}
+
+// TDMA: réveil LORA_TDMA_WAKE_EARLY_SEC avant le prochain beacon (s'il est trop
+// proche, le suivant). Sinon intervalle fixe.
+static int sleepSeconds() {
+#if LORA_TDMA
+    if (tdma.valid) {
+        RTCTime current;
+        RTC.getTime(current);
+        int32_t sec = (int32_t)(tdma.beaconTime + tdma.periodSec - current.getUnixTime()) - LORA_TDMA_WAKE_EARLY_SEC;
+        while (sec < 1) sec += tdma.periodSec;
+        return sec;
+    }
+#endif
+    return DEEP_SLEEP_INTERVAL_SEC;
+}
+
+// --- RETAINED STATE ---
+// Avec SLEEP_WARM_RESUME 0 chaque réveil repart de setup(). Ce qui doit survivre
+// au reset (séquence, réglage radio, synchro, trames à renvoyer, groupes FEC et
+// BATCH en cours, fenêtre de duty cycle) est recopié avant chaque veille dans un
+// bloc .noinit, repris au démarrage s'il est intact. Sans lui, chaque trame
+// repartait en séquence 0 et chaque réveil refaisait la synchro.
+// Changer les champs: incrémenter LORA_RETAINED_LAYOUT.
+#define LORA_RETAINED_LAYOUT 2
+
+struct LoraRetained {
+    RetainedHeader header;
+    uint8_t sequence;
+    uint8_t adr;
+    bool timeSynced;
+    uint32_t savedAt;     // Heure RTC de la sauvegarde
+    AirtimeWindow airtime;
+#if LORA_PROTOCOL_VERSION >= LORA_PROTO_V1 && LORA_EXPECTS_ACK
+    uint8_t adrPending;
+    uint8_t adrPendingCount;
+    uint8_t adrLosses;
+#endif
+#if LORA_LBT
+    uint8_t backoffExponent;
+#endif
+#if LORA_BATCH_SIZE <= 1 && LORA_PROTOCOL_VERSION >= LORA_PROTO_V1 && LORA_ACK_MODE != LORA_ACK_NONE
+    SentReading unconfirmed[LORA_ACK_MAP_BITS];
+    uint8_t unconfirmedCount;
+    uint8_t framesSinceAck;
+#endif
+#if LORA_FEC
+    uint8_t fecFirst;
+    uint8_t fecCount;
+    uint8_t fecParity[LORA_FEC_PAYLOAD_LEN];
+#endif
+#if LORA_BATCH_SIZE > 1
+    LoraReading pendingReadings[LORA_BATCH_MAX_READINGS];
+    uint8_t pendingCount;
+#endif
+};
+static LoraRetained retained RETAINED;
+
+static void saveRetained() {
+    RTCTime current;
+    RTC.getTime(current);
+    retained.sequence = sequenceCounter;
+    retained.adr = adrCurrent;
+    retained.timeSynced = isTimeSynced();
+    retained.savedAt = current.getUnixTime();
+    retained.airtime = airtime;
+#if LORA_PROTOCOL_VERSION >= LORA_PROTO_V1 && LORA_EXPECTS_ACK
+    retained.adrPending = adrPending;
+    retained.adrPendingCount = adrPendingCount;
+    retained.adrLosses = adrLosses;
+#endif
+#if LORA_LBT
+    retained.backoffExponent = backoffExponent;
+#endif
+#if LORA_BATCH_SIZE <= 1 && LORA_PROTOCOL_VERSION >= LORA_PROTO_V1 && LORA_ACK_MODE != LORA_ACK_NONE
+    memcpy(retained.unconfirmed, unconfirmed, sizeof(unconfirmed));
+    retained.unconfirmedCount = (uint8_t)unconfirmedCount;
+    retained.framesSinceAck = framesSinceAck;
+#endif
+#if LORA_FEC
+    retained.fecFirst = fecFirst;
+    retained.fecCount = fecCount;
+    memcpy(retained.fecParity, fecParity, sizeof(fecParity));
+#endif
+#if LORA_BATCH_SIZE > 1
+    memcpy(retained.pendingReadings, pendingReadings, sizeof(pendingReadings));
+    retained.pendingCount = (uint8_t)pendingCount;
+#endif
+    retained_seal(&retained.header, sizeof(retained), LORA_RETAINED_LAYOUT);
+}
+
+// false après une mise sous tension (ou un bloc corrompu): état par défaut
+static bool restoreRetained() {
+    if (!retained_valid(&retained.header, sizeof(retained), LORA_RETAINED_LAYOUT)) return false;
+    sequenceCounter = retained.sequence;
+    adrCurrent = retained.adr;
+    airtime = retained.airtime;
+#if LORA_PROTOCOL_VERSION >= LORA_PROTO_V1 && LORA_EXPECTS_ACK
+    adrPending = retained.adrPending;
+    adrPendingCount = retained.adrPendingCount;
+    adrLosses = retained.adrLosses;
+#endif
+#if LORA_LBT
+    backoffExponent = retained.backoffExponent;
+#endif
+#if LORA_BATCH_SIZE <= 1 && LORA_PROTOCOL_VERSION >= LORA_PROTO_V1 && LORA_ACK_MODE != LORA_ACK_NONE
+    memcpy(unconfirmed, retained.unconfirmed, sizeof(unconfirmed));
+    unconfirmedCount = retained.unconfirmedCount;
+    framesSinceAck = retained.framesSinceAck;
+#endif
+#if LORA_FEC
+    fecFirst = retained.fecFirst;
+    fecCount = retained.fecCount;
+    memcpy(fecParity, retained.fecParity, sizeof(fecParity));
+#endif
+#if LORA_BATCH_SIZE > 1
+    memcpy(pendingReadings, retained.pendingReadings, sizeof(pendingReadings));
+    pendingCount = retained.pendingCount;
+#endif
+
+    // Heure toujours valide si le RTC a continué de tourner (SleepManager::begin
+    // ne l'a pas remis à sa base par défaut)
+    RTCTime current;
+    RTC.getTime(current);
+    if (retained.timeSynced && current.getUnixTime() >= retained.savedAt) setTimeSyncStatus(true);
+    return true;
+}
+
+// Fin de cycle: la lecture est consommée, puis veille. Avec SLEEP_WARM_RESUME on
+// repart d'ici au réveil: module LoRa, heure et état radio sont conservés, il ne
+// reste qu'à attendre la lecture suivante (et en TDMA le beacon).
+static void sleepUntilNextCycle() {
+    while (isUserActive()) {
+        LOG_INFO("User Active - Holding Sleep...");
+        vTaskDelay(1000 / portTICK_PERIOD_MS);
+    }
+
+    logRadioStats();
+    consumeSensorData();
+    // Aussi avec la reprise à chaud: un reset imprévu (watchdog...) repart de là
+    saveRetained();
+    LOG_INFO("Sleeping...");
+    SleepManager::deepSleep(sleepSeconds());
+
+    LOG_INFO("Woke Up.");
+#if LORA_TDMA
+    waitForBeacon();
+#endif
 }
 
 void loraTask(void *pvParameters) {
     delay(1000);
     pinMode(LED_PIN, OUTPUT);
+    mac_key_init(&loraKey, (const uint8_t*)LORA_SHARED_SECRET, strlen(LORA_SHARED_SECRET));
+    // Graine propre au capteur: deux nœuds réveillés ensemble ne tirent pas les mêmes backoffs
+    randomSeed((SENSOR_ID * 2654435761UL) ^ micros());
+
+    // Reset de réveil: état repris avant l'init (le module est configuré au réglage ADR conservé)
+    if (restoreRetained()) {
+        LOG_INFO("Etat conservé: seq %u, SF%u, heure %s.", sequenceCounter, loraAdrSf(adrCurrent),
+                 isTimeSynced() ? "synchronisée" : "à synchroniser");
+    }
     
     // Boucle d'initialisation bloquante avec retry
     while (true) {
         if (initLoRaModule()) {
             break;
         }
-        Serial.println("[LoRaTask] Erreur Init. Nouvelle tentative dans 5s...");
+        LOG_ERROR("Erreur Init. Nouvelle tentative dans 5s...");
         vTaskDelay(5000 / portTICK_PERIOD_MS);
     }
 
-    Serial.println("[LoRaTask] Ready.");
+    LOG_INFO("Ready.");
 
     // --- TIME SYNC AT STARTUP ---
-    if(requestTimeSync()) {
+    // Heure du beacon (TDMA) ou de l'ACK de la première trame (LORA_ACK_SYNC),
+    // sinon échange TIME_REQ / TIME_RESP
+    // Heure conservée à travers le reset de réveil: pas de nouvel échange
+    bool synced = isTimeSynced();
+#if LORA_TDMA
+    mac_key_init(&beaconKey, (const uint8_t*)LORA_BEACON_SECRET, strlen(LORA_BEACON_SECRET));
+    if (waitForBeacon()) synced = true; // Toujours écouté: il donne aussi le créneau
+#endif
+#if !LORA_ACK_SYNC
+    if (!synced) synced = requestTimeSync();
+#endif
+    if (synced) {
         setTimeSyncStatus(true);
     }
     // ----------------------------
 
+#if !LORA_ACK_SYNC
     unsigned long lastSyncAttempt = 0;
+#endif
 
     for (;;) {
+#if !LORA_ACK_SYNC
         // Periodic Sync Check (Every 60s if not synced)
         if (!isTimeSynced()) {
             if (millis() - lastSyncAttempt > 60000) {
@@ -272,53 +1008,30 @@ void loraTask(void *pvParameters) {
                 }
             }
         }
+#endif
 
         SensorData data = getSensorData();
 
         if (data.valid) {
             digitalWrite(LED_PIN, HIGH);
             
-            bool success = sendSecurePacket(data.temperature, data.humidity);
+            bool success = transmitReading(data.temperature, data.humidity);
             
             digitalWrite(LED_PIN, LOW);
 
             if (success) {
-                Serial.println("[LoRaTask] Transfer Complete.");
-                
-                // Wait if User is interacting with UI
-                while (isUserActive()) {
-                    Serial.println("[LoRaTask] User Active - Holding Sleep...");
-                    vTaskDelay(1000 / portTICK_PERIOD_MS);
-                }
-                
-                Serial.println("[LoRaTask] Sleeping...");
-                SleepManager::deepSleep(DEEP_SLEEP_INTERVAL_SEC);
+                LOG_INFO("Transfer Complete.");
             } else {
-                Serial.println("[LoRaTask] Transfer Failed (No ACK). Retrying later...");
-                
-                while (isUserActive()) {
-                    Serial.println("[LoRaTask] User Active - Holding Sleep...");
-                    vTaskDelay(1000 / portTICK_PERIOD_MS);
-                }
-
                 // On failure, maybe sleep for a shorter time or retry immediately?
                 // For now, let's sleep to save battery, but maybe shorter.
-                SleepManager::deepSleep(DEEP_SLEEP_INTERVAL_SEC);
+                LOG_WARN("Transfer Failed (No ACK). Retrying later...");
             }
-            
-            // On Wake Up (Note: deepSleep reboots or resumes depending on implementation, 
-            // but in our fake sleep loop it just returns)
-            Serial.println("[LoRaTask] Woke Up. Re-init Serial...");
-            Serial1.end();
-            Serial1.begin(LORA_BAUD_RATE);
-            
-            // Wait for new sensor data
-            Serial.println("[LoRaTask] Waiting for fresh data...");
-            delay(2000); 
+            sleepUntilNextCycle();
 
         } else {
-            Serial.println("[LoRaTask] Waiting for valid sensor data...");
-            vTaskDelay(pdMS_TO_TICKS(1000));
+            // Au réveil (reprise à chaud) la lecture arrive en moins d'une seconde
+            LOG_DEBUG("Waiting for valid sensor data...");
+            vTaskDelay(pdMS_TO_TICKS(100));
         }
     }
 }
\ No newline at end of file
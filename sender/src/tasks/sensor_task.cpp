@@ -4,11 +4,15 @@
 #include "../config.h"
 #include "../utils/data_manager.h"
 
+#define LOG_MODULE "SensorTask"
+#define LOG_MODULE_LEVEL LOG_LEVEL_SENSOR
+#include "../utils/logger.h"
+
 // Initialisation du capteur DHT
 static DHT dht(SENSOR_DHT_PIN, SENSOR_DHT_TYPE);
 
 void sensorTask(void *pvParameters) {
-    Serial.println("[SensorTask] Initialisation DHT...");
+    LOG_INFO("Initialisation DHT...");
     dht.begin();
     
     // Attente initiale du capteur
@@ -19,7 +23,11 @@ void sensorTask(void *pvParameters) {
 
     for (;;) {
         // --- SECTION CRITIQUE ---
+        // Lecture forcée: millis() s'arrête pendant la veille, le garde-fou de 2 s
+        // de la bibliothèque rendrait la mesure d'avant la veille. L'écart réel
+        // entre deux lectures est assuré par le vTaskDelay (ticks rattrapés au réveil).
         taskENTER_CRITICAL();
+        dht.read(true);
         float h = dht.readHumidity();
         float t = dht.readTemperature();
         taskEXIT_CRITICAL();
@@ -27,9 +35,7 @@ void sensorTask(void *pvParameters) {
 
         if (isnan(h) || isnan(t)) {
             errorCount++;
-            Serial.print("[SensorTask] Echec lecture DHT (");
-            Serial.print(errorCount);
-            Serial.println(")");
+            LOG_WARN("Echec lecture DHT (%d)", errorCount);
 
             if (errorCount >= MAX_ERRORS) {
                 setDhtStatus(false);
@@ -38,15 +44,11 @@ void sensorTask(void *pvParameters) {
             }
         } else {
             if (errorCount > 0) {
-                 Serial.println("[SensorTask] Capteur DHT rétabli !");
+                 LOG_INFO("Capteur DHT rétabli !");
             }
             errorCount = 0;
             
-            Serial.print("[SensorTask] Lecture -> Temp: ");
-            Serial.print(t);
-            Serial.print("°C, Hum: ");
-            Serial.print(h);
-            Serial.println("%");
+            LOG_INFO("Lecture -> Temp: %f°C, Hum: %f%%", t, h);
 
             updateSensorData(t, h);
             setDhtStatus(true);
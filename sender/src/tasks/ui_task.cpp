@@ -1,11 +1,14 @@
 #include "ui_task.h"
 #include <Arduino.h>
 #include <Arduino_FreeRTOS.h>
+#include <RTC.h>
+#include <button_manager.h>
+#include <led_matrix_manager.h>
 #include "../config.h"
-#include "../utils/button_manager.h"
-#include "../utils/led_matrix_manager.h"
 #include "../utils/data_manager.h"
-#include <RTC.h>
+
+#define LOG_MODULE "UI"
+#include "../utils/logger.h"
 
 // Initialize Button Manager with Config Pins
 static ButtonManager buttons(BUTTON_LEFT_PIN, BUTTON_RIGHT_PIN);
@@ -18,7 +21,7 @@ enum ScreenState {
 };
 
 void uiTask(void *pvParameters) {
-    Serial.println("[UITask] Initialisation...");
+    LOG_INFO("Initialisation...");
     
     buttons.begin();
     initLedMatrix();
@@ -36,7 +39,7 @@ void uiTask(void *pvParameters) {
         bool anyInput = false;
 
         if (buttons.isLeftPressed()) {
-            Serial.println("[UI] Button LEFT");
+            LOG_INFO("Button LEFT");
             anyInput = true;
             if (currentState == SCREEN_OFF) {
                 currentState = activeScreen; 
@@ -48,7 +51,7 @@ void uiTask(void *pvParameters) {
                 currentState = activeScreen;
             }
         } else if (buttons.isRightPressed()) {
-            Serial.println("[UI] Button RIGHT");
+            LOG_INFO("Button RIGHT");
             anyInput = true;
             if (currentState == SCREEN_OFF) {
                 currentState = activeScreen;
@@ -68,7 +71,7 @@ void uiTask(void *pvParameters) {
 
         if (currentState != SCREEN_OFF) {
             if (now - lastInteraction > TIMEOUT) {
-                Serial.println("[UI] Timeout -> Screen OFF");
+                LOG_INFO("Timeout -> Screen OFF");
                 currentState = SCREEN_OFF;
                 clearLedMatrix();
                 setUserActive(false); // Allow Sleep
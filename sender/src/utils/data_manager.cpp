@@ -64,6 +64,13 @@ SensorData getSensorData() {
     return data;
 }
 
+void consumeSensorData() {
+    if (xSemaphoreTake(dataMutex, portMAX_DELAY)) {
+        currentData.valid = false;
+        xSemaphoreGive(dataMutex);
+    }
+}
+
 void setUserActive(bool isActive) {
     if (xSemaphoreTake(dataMutex, portMAX_DELAY)) {
         userActive = isActive;
@@ -17,6 +17,10 @@ void updateSensorData(float temp, float hum);
 // Récupérer les données
 SensorData getSensorData();
 
+// Marque la lecture comme envoyée: getSensorData() la rend invalide jusqu'à la
+// suivante (reprise à chaud, la lecture d'avant la veille n'est pas renvoyée)
+void consumeSensorData();
+
 // UI State
 void setUserActive(bool isActive);
 bool isUserActive();
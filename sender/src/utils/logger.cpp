@@ -0,0 +1,170 @@
+#include "logger.h"
+#include <Arduino_FreeRTOS.h>
+#include <stdio.h>
+
+// Multi-producer / single-consumer ring. Producers claim a slot by bumping
+// _head (CAS, LDREX/STREX on the M4), fill it and set `ready`; the drain task
+// prints slots in order and releases them by bumping _tail.
+static LogRecord ring[LOG_RING_SIZE];
+static uint32_t _head = 0;
+static uint32_t _tail = 0;
+static uint32_t _dropped = 0;
+
+LogRecord *logger_reserve(uint8_t level, const char *module, const char *fmt) {
+    uint32_t head = __atomic_load_n(&_head, __ATOMIC_RELAXED);
+    do {
+        if (head - __atomic_load_n(&_tail, __ATOMIC_ACQUIRE) >= LOG_RING_SIZE) {
+            __atomic_fetch_add(&_dropped, 1, __ATOMIC_RELAXED);
+            return NULL;
+        }
+    } while (!__atomic_compare_exchange_n(&_head, &head, head + 1, true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+
+    LogRecord *rec = &ring[head & (LOG_RING_SIZE - 1)];
+    rec->level = level;
+    rec->module = module;
+    rec->fmt = fmt;
+    rec->strUsed = 0;
+    return rec;
+}
+
+void logger_commit(LogRecord *rec, uint8_t argCount) {
+    rec->argCount = argCount;
+    __atomic_store_n(&rec->ready, 1, __ATOMIC_RELEASE);
+}
+
+uint32_t logger_arg(LogRecord *rec, const char *s) {
+    uint8_t offset = rec->strUsed;
+    size_t room = LOG_STR_BYTES - offset;
+    if (room == 0) return offset - 1; // Points at the previous terminator: ""
+    size_t n = strnlen(s, room - 1);
+    memcpy(rec->strings + offset, s, n);
+    rec->strings[offset + n] = '\0';
+    rec->strUsed = offset + n + 1;
+    return offset;
+}
+
+uint32_t logger_dropped() {
+    return __atomic_load_n(&_dropped, __ATOMIC_RELAXED);
+}
+
+// --- Drain side ---
+
+// Expands rec->fmt into out (NUL-terminated), one conversion at a time
+static size_t formatRecord(const LogRecord *rec, char *out, size_t cap) {
+    size_t len = 0;
+    uint8_t argIndex = 0;
+    const char *p = rec->fmt;
+
+    while (*p != '\0' && len < cap - 1) {
+        if (*p != '%') {
+            out[len++] = *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            out[len++] = '%';
+            p += 2;
+            continue;
+        }
+
+        // Copy the spec ("%-08.3l" ...) up to its conversion character
+        char spec[12];
+        size_t specLen = 0;
+        spec[specLen++] = *p++;
+        while (*p != '\0' && strchr("-+ #0123456789.l", *p) != NULL) {
+            if (*p != 'l' && specLen < sizeof(spec) - 2) spec[specLen++] = *p;
+            p++;
+        }
+        char conv = *p;
+        if (conv == '\0') break;
+        p++;
+        spec[specLen++] = conv;
+        spec[specLen] = '\0';
+
+        uint32_t arg = (argIndex < rec->argCount) ? rec->args[argIndex] : 0;
+        argIndex++;
+
+        int n = 0;
+        switch (conv) {
+        case 'd': case 'i':
+            n = snprintf(out + len, cap - len, spec, (int)(int32_t)arg);
+            break;
+        case 'u': case 'x': case 'X':
+            n = snprintf(out + len, cap - len, spec, (unsigned int)arg);
+            break;
+        case 'c':
+            n = snprintf(out + len, cap - len, spec, (int)arg);
+            break;
+        case 's':
+            n = snprintf(out + len, cap - len, spec, arg < LOG_STR_BYTES ? rec->strings + arg : "");
+            break;
+        case 'f': {
+            // newlib-nano printf has no float support: dtostrf, precision 2 by default
+            // (same as Serial.print(float))
+            float f;
+            memcpy(&f, &arg, sizeof(f));
+            const char *dot = strchr(spec, '.');
+            int prec = dot ? atoi(dot + 1) : 2;
+            int width = atoi(spec + 1 + (spec[1] == '-' || spec[1] == '0'));
+            char num[20];
+            dtostrf(f, 1, prec, num);
+            n = snprintf(out + len, cap - len, spec[1] == '-' ? "%-*s" : "%*s", width, num);
+            break;
+        }
+        default:
+            n = snprintf(out + len, cap - len, "%s", spec);
+            break;
+        }
+        if (n > 0) len += ((size_t)n < cap - len) ? (size_t)n : cap - 1 - len;
+    }
+    out[len] = '\0';
+    return len;
+}
+
+// Prints the next committed slot, false if there is none
+static bool drainOne() {
+    static char line[160];
+    uint32_t tail = __atomic_load_n(&_tail, __ATOMIC_RELAXED);
+    if (tail == __atomic_load_n(&_head, __ATOMIC_ACQUIRE)) return false;
+
+    LogRecord *rec = &ring[tail & (LOG_RING_SIZE - 1)];
+    if (!__atomic_load_n(&rec->ready, __ATOMIC_ACQUIRE)) return false; // Still being written
+
+    int header = snprintf(line, sizeof(line), "[%s] ", rec->module);
+    size_t len = (header > 0 && (size_t)header < sizeof(line) / 2) ? header : 0;
+    len += formatRecord(rec, line + len, sizeof(line) - len);
+
+    rec->ready = 0;
+    __atomic_store_n(&_tail, tail + 1, __ATOMIC_RELEASE);
+
+    Serial.write((const uint8_t *)line, len);
+    Serial.write((const uint8_t *)"\r\n", 2);
+    return true;
+}
+
+static void loggerTask(void *pvParameters) {
+    uint32_t reportedDrops = 0;
+    for (;;) {
+        while (drainOne()) {}
+
+        uint32_t dropped = logger_dropped();
+        if (dropped != reportedDrops) {
+            Serial.print("[Log] ");
+            Serial.print(dropped - reportedDrops);
+            Serial.println(" message(s) perdu(s), buffer plein.");
+            reportedDrops = dropped;
+        }
+        vTaskDelay(10 / portTICK_PERIOD_MS);
+    }
+}
+
+bool logger_begin() {
+    return xTaskCreate(loggerTask, "Logger", 256, NULL, tskIDLE_PRIORITY, NULL) == pdPASS;
+}
+
+void logger_flush(uint32_t timeoutMs) {
+    uint32_t tStart = millis();
+    while (__atomic_load_n(&_tail, __ATOMIC_ACQUIRE) != __atomic_load_n(&_head, __ATOMIC_ACQUIRE) &&
+           millis() - tStart < timeoutMs) {
+        vTaskDelay(1);
+    }
+}
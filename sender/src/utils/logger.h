@@ -0,0 +1,122 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+// Deferred logging. A log call only copies the format pointer and its arguments
+// into a slot of a lock-free ring (a few dozen cycles, callable from any task
+// or ISR); a lowest-priority task formats the slots and writes them to Serial.
+// When the ring is full the message is dropped and counted.
+//
+// Usage, in a .cpp, before including this header:
+//     #define LOG_MODULE "LoRa"
+//     #define LOG_MODULE_LEVEL LOG_LEVEL_LORA   // optional, defaults to LOG_LEVEL
+//     #include "../utils/logger.h"
+//     LOG_INFO("Sequence %u, RSSI %d", seq, rssi);
+// Calls above the module level compile to nothing (the arguments are still
+// type-checked, but never evaluated).
+//
+// Formats: %d %i %u %x %X %c %s %f %% with optional flags/width/precision.
+// Up to LOG_MAX_ARGS arguments; %s strings are copied (LOG_STR_BYTES per
+// message, longer ones are cut).
+
+#include <Arduino.h>
+#include "../config.h"
+
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+#ifndef LOG_RING_SIZE
+#define LOG_RING_SIZE 16   // power of two
+#endif
+
+#define LOG_MAX_ARGS 6
+#define LOG_STR_BYTES 24
+
+struct LogRecord {
+    volatile uint8_t ready;
+    uint8_t level;
+    uint8_t argCount;
+    uint8_t strUsed;
+    const char *module;
+    const char *fmt;
+    uint32_t args[LOG_MAX_ARGS];
+    char strings[LOG_STR_BYTES];
+};
+
+// Starts the drain task. Messages logged before are kept in the ring.
+bool logger_begin();
+
+// Blocks (up to timeoutMs) until the ring is written out, e.g. before standby
+void logger_flush(uint32_t timeoutMs = 200);
+
+uint32_t logger_dropped();
+
+// --- Internals used by the macros ---
+LogRecord *logger_reserve(uint8_t level, const char *module, const char *fmt);
+void logger_commit(LogRecord *rec, uint8_t argCount);
+
+inline uint32_t logger_arg(LogRecord *, int v) { return (uint32_t)v; }
+inline uint32_t logger_arg(LogRecord *, unsigned int v) { return v; }
+inline uint32_t logger_arg(LogRecord *, long v) { return (uint32_t)v; }
+inline uint32_t logger_arg(LogRecord *, unsigned long v) { return (uint32_t)v; }
+inline uint32_t logger_arg(LogRecord *, double v) {
+    float f = (float)v;
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+uint32_t logger_arg(LogRecord *rec, const char *s);
+inline uint32_t logger_arg(LogRecord *rec, const String &s) { return logger_arg(rec, s.c_str()); }
+
+template <typename... Args>
+inline void logger_write(uint8_t level, const char *module, const char *fmt, const Args &... args) {
+    static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "too many log arguments");
+    LogRecord *rec = logger_reserve(level, module, fmt);
+    if (rec == NULL) return;
+    uint8_t i = 0;
+    int expand[] = { 0, ((rec->args[i] = logger_arg(rec, args)), i++, 0)... };
+    (void)expand;
+    logger_commit(rec, i);
+}
+
+#endif // LOGGER_H
+
+// Per-module macros: outside the include guard, so each .cpp gets its own
+// LOG_MODULE / LOG_MODULE_LEVEL
+#ifndef LOG_MODULE
+#define LOG_MODULE "?"
+#endif
+#ifndef LOG_MODULE_LEVEL
+#define LOG_MODULE_LEVEL LOG_LEVEL
+#endif
+
+#undef LOG_ERROR
+#undef LOG_WARN
+#undef LOG_INFO
+#undef LOG_DEBUG
+
+#if LOG_MODULE_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) logger_write(LOG_LEVEL_ERROR, LOG_MODULE, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) do { if (0) logger_write(LOG_LEVEL_ERROR, LOG_MODULE, __VA_ARGS__); } while (0)
+#endif
+#if LOG_MODULE_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(...) logger_write(LOG_LEVEL_WARN, LOG_MODULE, __VA_ARGS__)
+#else
+#define LOG_WARN(...) do { if (0) logger_write(LOG_LEVEL_WARN, LOG_MODULE, __VA_ARGS__); } while (0)
+#endif
+#if LOG_MODULE_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) logger_write(LOG_LEVEL_INFO, LOG_MODULE, __VA_ARGS__)
+#else
+#define LOG_INFO(...) do { if (0) logger_write(LOG_LEVEL_INFO, LOG_MODULE, __VA_ARGS__); } while (0)
+#endif
+#if LOG_MODULE_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) logger_write(LOG_LEVEL_DEBUG, LOG_MODULE, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) do { if (0) logger_write(LOG_LEVEL_DEBUG, LOG_MODULE, __VA_ARGS__); } while (0)
+#endif
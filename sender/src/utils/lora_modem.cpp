@@ -0,0 +1,267 @@
+#include "lora_modem.h"
+#include <hex_codec.h>
+#include <stdio.h>
+
+#define LOG_MODULE "LoRaModem"
+#define LOG_MODULE_LEVEL LOG_LEVEL_MODEM
+#include "logger.h"
+
+static const char TX_PREFIX[] = "AT+TEST=TXLRPKT,\"";
+static const char RSSI_COMMAND[] = "AT+TEST=RSSI,868,10"; // 868 MHz as RFCFG, 10 samples
+
+bool LoRaModem::begin(unsigned long baud) {
+    if (_cmdQueue != NULL) return true;
+
+    Serial1.begin(baud);
+    _cmdQueue = xQueueCreate(CMD_QUEUE_LEN, sizeof(PendingCommand));
+    _rxQueue = xQueueCreate(RX_QUEUE_LEN, sizeof(LoraRxPacket));
+    if (_cmdQueue == NULL || _rxQueue == NULL) return false;
+
+    // Above the LoRa task so a terminal line is handled as soon as it is read
+    if (xTaskCreate(pumpTask, "LoRaModem", 256, this, 3, &_pumpTask) != pdPASS) return false;
+
+#if LORA_MODEM_UART_ISR
+    _isrRx = installUartIsr();
+    if (!_isrRx) LOG_WARN("RX ISR unavailable, polling Serial1.");
+#endif
+    return true;
+}
+
+ModemResult LoRaModem::command(const char *cmd, const char *expect, uint32_t timeoutMs) {
+    if (_cmdQueue == NULL) return MODEM_BUSY;
+
+    PendingCommand pending = { cmd, expect, timeoutMs, xTaskGetCurrentTaskHandle() };
+
+    // Clear a notification left over from an earlier command
+    xTaskNotifyWait(0, 0xFFFFFFFF, NULL, 0);
+    if (xQueueSend(_cmdQueue, &pending, 0) != pdTRUE) return MODEM_BUSY;
+    xTaskNotifyGive(_pumpTask);
+
+    // The pump enforces timeoutMs once the command is written; the margin covers
+    // the commands queued ahead of this one.
+    uint32_t result;
+    if (xTaskNotifyWait(0, 0xFFFFFFFF, &result, pdMS_TO_TICKS(timeoutMs * CMD_QUEUE_LEN + 100)) != pdTRUE) {
+        return MODEM_TIMEOUT;
+    }
+    return (ModemResult)result;
+}
+
+ModemResult LoRaModem::transmit(const uint8_t *frame, size_t len, uint32_t timeoutMs) {
+    if (len > LORA_MAX_FRAME_LEN) return MODEM_ERROR;
+
+    size_t n = sizeof(TX_PREFIX) - 1;
+    memcpy(_txCommand, TX_PREFIX, n);
+    n += hex_encode(frame, len, _txCommand + n);
+    memcpy(_txCommand + n, "\"\r\n", 4); // Closing quote, CRLF and NUL
+
+    return command(_txCommand, "+TEST: TX DONE", timeoutMs);
+}
+
+ModemResult LoRaModem::configure(uint8_t sf, int8_t powerDbm) {
+    snprintf(_cfgCommand, sizeof(_cfgCommand), "AT+TEST=RFCFG,868,SF%u,%u,%u,%u,%d\r\n", sf, LORA_BW_KHZ,
+             LORA_TX_PREAMBLE, LORA_RX_PREAMBLE, powerDbm);
+    ModemResult result = command(_cfgCommand, "+TEST: RFCFG");
+    if (result == MODEM_OK) _sf = sf;
+    return result;
+}
+
+ModemResult LoRaModem::startReceive() {
+    return command("AT+TEST=RXLRPKT", "+TEST: RXLRPKT");
+}
+
+ModemResult LoRaModem::channelRssi(int *rssiDbm) {
+    ModemResult result = command(RSSI_COMMAND, "+TEST: RSSI");
+    if (result != MODEM_OK) return result;
+
+    // Last number of the line: "+TEST: RSSI, -112"
+    const char *end = _response + strlen(_response);
+    const char *p = end;
+    while (p > _response && p[-1] >= '0' && p[-1] <= '9') p--;
+    if (p == end) return MODEM_ERROR;
+    bool negative = p > _response && p[-1] == '-';
+    int value = atoi(p);
+    *rssiDbm = negative ? -value : value;
+    return MODEM_OK;
+}
+
+bool LoRaModem::receive(LoraRxPacket *packet, uint32_t timeoutMs) {
+    if (_rxQueue == NULL) return false;
+    TickType_t ticks = (timeoutMs == WAIT_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(timeoutMs);
+    return xQueueReceive(_rxQueue, packet, ticks) == pdTRUE;
+}
+
+void LoRaModem::flushReceived() {
+    LoraRxPacket stale;
+    while (_rxQueue != NULL && xQueueReceive(_rxQueue, &stale, 0) == pdTRUE) {}
+}
+
+// --- Pump task ---
+
+void LoRaModem::pumpTask(void *pvParameters) {
+    static_cast<LoRaModem*>(pvParameters)->pump();
+}
+
+void LoRaModem::pump() {
+    for (;;) {
+        if (!_busy && xQueueReceive(_cmdQueue, &_active, 0) == pdTRUE) {
+            startCommand();
+        }
+
+        drainUart();
+
+        if (_busy && (int32_t)(millis() - _deadline) >= 0) {
+            finishCommand(MODEM_TIMEOUT);
+            continue;
+        }
+
+        // Sleep until the ISR completes a line, a command is queued or the
+        // current command expires. Without the ISR: one tick between UART
+        // checks (~10 bytes at 9600 baud).
+        TickType_t wait = 1;
+        if (_isrRx && !_busy) {
+            wait = portMAX_DELAY;
+        } else if (_isrRx) {
+            int32_t remaining = (int32_t)(_deadline - millis());
+            wait = pdMS_TO_TICKS(remaining > 0 ? remaining : 0) + 1;
+        }
+        ulTaskNotifyTake(pdTRUE, wait);
+    }
+}
+
+void LoRaModem::drainUart() {
+    if (!_isrRx) {
+        while (Serial1.available()) feed((char)Serial1.read());
+        return;
+    }
+
+    uint8_t chunk[32];
+    size_t n;
+    while ((n = xStreamBufferReceive(_uartStream, chunk, sizeof(chunk), 0)) > 0) {
+        for (size_t i = 0; i < n; i++) feed((char)chunk[i]);
+    }
+}
+
+// Serial1.write() blocks until the SCI transfer is done: commands built in a
+// buffer (TX, RFCFG) carry their CRLF and go out in a single transfer.
+void LoRaModem::startCommand() {
+    size_t len = strlen(_active.text);
+    Serial1.write(_active.text, len);
+    if (len == 0 || _active.text[len - 1] != '\n') Serial1.write("\r\n", 2);
+    _deadline = millis() + _active.timeoutMs;
+    _busy = true;
+}
+
+void LoRaModem::finishCommand(ModemResult result) {
+    _busy = false;
+    xTaskNotify(_active.waiter, result, eSetValueWithOverwrite);
+}
+
+void LoRaModem::feed(char c) {
+    if (c == '\r') return;
+    if (c != '\n') {
+        if (_lineLen < LINE_MAX) _line[_lineLen++] = c;
+        else _lineOverflow = true;
+        return;
+    }
+
+    // Every '\n' seen by the ISR left a timestamp, consume it even for dropped lines
+    uint32_t t0 = micros();
+    uint32_t stamp = t0;
+    if (_isrRx && _stampTail != _stampHead) {
+        stamp = _lineStamps[_stampTail];
+        _stampTail = (_stampTail + 1) & (LINE_STAMPS - 1);
+    }
+
+    if (_lineOverflow) {
+        _stats.rejected++;
+    } else if (_lineLen > 0) {
+        _line[_lineLen] = '\0';
+        handleLine(_line, _lineLen, stamp);
+        uint32_t elapsed = micros() - t0;
+        _stats.lines++;
+        if (elapsed > _stats.maxLineUs) _stats.maxLineUs = elapsed;
+    }
+    _lineLen = 0;
+    _lineOverflow = false;
+}
+
+void LoRaModem::handleLine(const char *line, size_t len, uint32_t timestampUs) {
+    // Receive URCs first: they can arrive in the middle of any command
+    switch (lora_parse_rx_line(line, len, &_lastMeta, _rx.frame, LORA_MAX_FRAME_LEN, &_rx.len)) {
+    case RX_LINE_META:
+        return;
+
+    case RX_LINE_FRAME:
+        // RSSI/SNR only count if the LEN line announced this frame (0 = unknown)
+        if (_lastMeta.len == (int)_rx.len) {
+            _rx.rssi = _lastMeta.rssi;
+            _rx.snr = _lastMeta.snr;
+        } else {
+            _rx.rssi = 0;
+            _rx.snr = 0;
+        }
+        _lastMeta.len = -1;
+        _rx.timestampUs = timestampUs;
+        if (xQueueSend(_rxQueue, &_rx, 0) != pdTRUE) _stats.framesDropped++;
+        return;
+
+    case RX_LINE_MALFORMED:
+        _stats.rejected++;
+        return;
+
+    case RX_LINE_OTHER:
+        break;
+    }
+
+    if (!_busy) return;
+    if (strstr(line, _active.expect) != NULL) {
+        size_t n = len < RESPONSE_MAX ? len : RESPONSE_MAX;
+        memcpy(_response, line, n);
+        _response[n] = '\0';
+        finishCommand(MODEM_OK);
+    } else if (strstr(line, "ERROR") != NULL) finishCommand(MODEM_ERROR);
+}
+
+#if LORA_MODEM_UART_ISR
+// --- UART RX interrupt (UNO R4: Serial1 = SCI2 on D0/D1) ---
+
+// The core registers the FSP SCI driver for Serial1 in Serial1.begin(). Find the
+// ICU slot linked to SCI2 RXI, get its driver instance and chain our callback
+// in front of the core's: RX bytes come here, TX/error events go on to the core.
+bool LoRaModem::installUartIsr() {
+    _uartStream = xStreamBufferCreate(UART_STREAM_LEN, 1);
+    if (_uartStream == NULL) return false;
+
+    for (uint32_t irq = 0; irq < BSP_ICU_VECTOR_MAX_ENTRIES; irq++) {
+        if ((R_ICU->IELSR[irq] & R_ICU_IELSR_IELS_Msk) != ELC_EVENT_SCI2_RXI) continue;
+
+        uart_ctrl_t *ctrl = (uart_ctrl_t *)R_FSP_IsrContextGet((IRQn_Type)irq);
+        if (ctrl == NULL) return false;
+        return R_SCI_UART_CallbackSet(ctrl, uartCallback, this, NULL) == FSP_SUCCESS;
+    }
+    return false;
+}
+
+void LoRaModem::uartCallback(uart_callback_args_t *p_args) {
+    if (p_args->event != UART_EVENT_RX_CHAR) {
+        UART::WrapperCallback(p_args);
+        return;
+    }
+
+    LoRaModem *modem = (LoRaModem *)p_args->p_context;
+    uint8_t c = (uint8_t)p_args->data;
+    BaseType_t woken = pdFALSE;
+
+    if (xStreamBufferSendFromISR(modem->_uartStream, &c, 1, &woken) != 1) {
+        modem->_stats.uartOverruns++;
+    } else if (c == '\n') {
+        uint8_t next = (modem->_stampHead + 1) & (LINE_STAMPS - 1);
+        if (next != modem->_stampTail) {
+            modem->_lineStamps[modem->_stampHead] = micros();
+            modem->_stampHead = next;
+        }
+        vTaskNotifyGiveFromISR(modem->_pumpTask, &woken);
+    }
+    portYIELD_FROM_ISR(woken);
+}
+#endif
@@ -0,0 +1,29 @@
+#include "retained_state.h"
+
+static const uint32_t RETAINED_MAGIC = 0x52345254; // "R4RT"
+
+// CRC-32 (IEEE, reflected), bit by bit: a few hundred bytes once per cycle
+static uint32_t crc32(const uint8_t *data, size_t len) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+    }
+    return ~crc;
+}
+
+static uint32_t blockCrc(const RetainedHeader *block, size_t size) {
+    return crc32((const uint8_t *)(block + 1), size - sizeof(RetainedHeader));
+}
+
+bool retained_valid(const RetainedHeader *block, size_t size, uint16_t layout) {
+    return block->magic == RETAINED_MAGIC && block->layout == layout && block->size == size &&
+           block->crc == blockCrc(block, size);
+}
+
+void retained_seal(RetainedHeader *block, size_t size, uint16_t layout) {
+    block->magic = RETAINED_MAGIC;
+    block->layout = layout;
+    block->size = (uint16_t)size;
+    block->crc = blockCrc(block, size);
+}
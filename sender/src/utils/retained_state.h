@@ -0,0 +1,35 @@
+#ifndef RETAINED_STATE_H
+#define RETAINED_STATE_H
+
+// State kept across the reset-based wake (SLEEP_WARM_RESUME 0). A variable in
+// .noinit is not cleared at boot, and the RA4M1 keeps its SRAM powered in
+// software standby and through NVIC_SystemReset(): what the firmware wrote
+// before the reset is still there. After a power-on it holds garbage, so each
+// block starts with a header (magic, layout, size, CRC-32) and is only trusted
+// when the header matches.
+//
+//     struct CounterState { RetainedHeader header; uint8_t counter; };
+//     static CounterState state RETAINED;
+//     if (retained_valid(&state.header, sizeof(state), COUNTER_LAYOUT)) counter = state.counter;
+//     ...
+//     state.counter = counter;
+//     retained_seal(&state.header, sizeof(state), COUNTER_LAYOUT);  // before sleeping
+
+#include <Arduino.h>
+
+#define RETAINED __attribute__((section(".noinit")))
+
+struct RetainedHeader {
+    uint32_t magic;
+    uint16_t layout;  // Bumped by the owner when the fields of its block change
+    uint16_t size;
+    uint32_t crc;     // CRC-32 of the block after the header
+};
+
+// True if the block (size bytes, header first) was sealed with this layout
+bool retained_valid(const RetainedHeader *block, size_t size, uint16_t layout);
+
+// Stamps the header over the current contents of the block
+void retained_seal(RetainedHeader *block, size_t size, uint16_t layout);
+
+#endif // RETAINED_STATE_H
@@ -1,16 +1,35 @@
 #include "sleep_manager.h"
+#include "logger.h"
+#include "retained_state.h"
+#include "../config.h"
 #include <WiFiS3.h> // Required to control the ESP32 module
 #include <Arduino_FreeRTOS.h>
 
 // Flag to indicate wake-up source
 volatile bool alarmWakeUp = false;
 
+// Total time spent in standby, added to millis() by uptimeMs()
+static uint32_t sleptMs = 0;
+
+// uptimeMs() at the reset-based wake, so it goes on across the reset
+#define CLOCK_LAYOUT 1
+struct RetainedClock {
+    RetainedHeader header;
+    uint32_t uptimeMs;
+};
+static RetainedClock retainedClock RETAINED;
+
 void SleepManager::begin() {
     // Ensure ESP32 (WiFi Module) is OFF to save power immediately (Sender mode)
     WiFi.disconnect();
     WiFi.end();
 
     RTC.begin();
+    // Reset-based wake: the RTC kept counting (and the synchronized time with it)
+    if (RTC.isRunning() && retained_valid(&retainedClock.header, sizeof(retainedClock), CLOCK_LAYOUT)) {
+        sleptMs = retainedClock.uptimeMs;
+        return;
+    }
     // Initialize with a default time base so the RTC starts ticking.
     RTCTime startTime(1, Month::JANUARY, 2024, 0, 0, 0, DayOfWeek::MONDAY, SaveLight::SAVING_TIME_INACTIVE);
     RTC.setTime(startTime);
@@ -20,23 +39,26 @@ void SleepManager::alarmCallback() {
     alarmWakeUp = true;
 }
 
+uint32_t SleepManager::uptimeMs() {
+    return millis() + sleptMs;
+}
+
 void SleepManager::deepSleep(int secondsDuration) {
+    // Let the deferred log catch up before writing to Serial directly
+    logger_flush();
+
     Serial.print("[SleepManager] Entering Deep Sleep for ");
     Serial.print(secondsDuration);
     Serial.println("s...");
 
-    // 1. SHUTDOWN ESP32 (WiFi)
-    // Even if not using WiFi, we ensure it's off to save power
-    WiFi.disconnect();
-    WiFi.end(); 
-    Serial.println("[SleepManager] ESP32: OFF");
-
-    // 2. CONFIGURE RTC ALARM
+    // 1. CONFIGURE RTC ALARM
+    // (the ESP32 was shut down once in begin() and stays off)
     RTCTime current;
     RTC.getTime(current);
+    uint32_t asleepAt = current.getUnixTime();
     
     // Calculate wake up time using Unix Timestamp math
-    RTCTime alarmTime(current.getUnixTime() + secondsDuration);
+    RTCTime alarmTime(asleepAt + secondsDuration);
     
     AlarmMatch match;
     match.addMatchHour();
@@ -45,7 +67,7 @@ void SleepManager::deepSleep(int secondsDuration) {
     
     RTC.setAlarmCallback(SleepManager::alarmCallback, alarmTime, match);
 
-    // 3. ENTER RA4M1 STANDBY
+    // 2. ENTER RA4M1 STANDBY
     Serial.println("[SleepManager] RA4M1: Entering Standby...");
     Serial.flush(); 
 
@@ -54,11 +76,36 @@ void SleepManager::deepSleep(int secondsDuration) {
     // =================================
     // SYSTEM WAKES UP HERE
     // =================================
-    
-    // Request a software reset to re-initialize everything cleanly
+
+#if SLEEP_WARM_RESUME
+    // Back to the caller: setup(), module init, DHT warm-up and time sync are skipped
+    resume(asleepAt);
+    Serial.println("[SleepManager] Waking up... Warm resume.");
+#else
+    // Request a software reset to re-initialize everything cleanly.
+    // The clock (sleep included) is handed over to begin() after the reset.
+    resume(asleepAt);
+    retainedClock.uptimeMs = uptimeMs();
+    retained_seal(&retainedClock.header, sizeof(retainedClock), CLOCK_LAYOUT);
     Serial.println("[SleepManager] Waking up... Performing System Reset.");
     Serial.flush();
     NVIC_SystemReset();
+#endif
+}
+
+// Software standby keeps SRAM and the peripheral registers (SCI, GPIO, RTC):
+// nothing to re-initialize, only the clocks stopped. SysTick is restarted by
+// enterStandbyMode(); the tick count is caught up here, once the scheduler runs
+// again. The RTC counts whole seconds and the alarm fires on a second boundary,
+// so one second less than the RTC difference never exceeds the real sleep:
+// delays and the duty-cycle window stay on the safe side.
+void SleepManager::resume(uint32_t asleepAt) {
+    RTCTime current;
+    RTC.getTime(current);
+    uint32_t elapsed = current.getUnixTime() - asleepAt;
+    uint32_t ms = elapsed > 1 ? (elapsed - 1) * 1000UL : 0;
+    sleptMs += ms;
+    xTaskCatchUpTicks(ms / portTICK_PERIOD_MS);
 }
 
 void SleepManager::enterStandbyMode(uint32_t sleepDurationS) {
@@ -86,10 +133,10 @@ void SleepManager::enterStandbyMode(uint32_t sleepDurationS) {
     SysTick->VAL = 0;
     SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
 
-    // 6. COMPENSER LE TEMPS DANS FREERTOS (Désactivé)
-    // vTaskStepTick n'est pas disponible dans la config Arduino FreeRTOS par défaut.
-    // Les timers logiciels FreeRTOS seront "en pause" durant le sommeil.
-    // vTaskStepTick(pdMS_TO_TICKS(sleepDurationS * 1000));
+    // 6. COMPENSER LE TEMPS DANS FREERTOS
+    // vTaskStepTick n'est pas disponible dans la config Arduino FreeRTOS par défaut
+    // (pas de tickless idle): resume() rattrape les ticks avec xTaskCatchUpTicks,
+    // qui exige l'ordonnanceur actif, donc après xTaskResumeAll().
 
     // 7. RELANCER LES PÉRIPHÉRIQUES
     // Sur RA4M1, après un standby, il est parfois nécessaire de ré-autoriser 
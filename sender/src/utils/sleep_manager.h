@@ -13,21 +13,28 @@ public:
      * @brief Enters Deep Sleep mode for a specific duration.
      * 
      * Actions performed:
-     * 1. Shuts down the WiFi/ESP32 module completely.
-     * 2. Configures the RTC alarm for the specified duration.
-     * 3. Enters RA4M1 Standby mode (low power).
-     * 4. Wakes up and restarts WiFi (if configured to do so by the caller later).
+     * 1. Configures the RTC alarm for the specified duration.
+     * 2. Enters RA4M1 Standby mode (low power, the ESP32 is off since begin()).
+     * 3. Wakes up and either returns to the caller (SLEEP_WARM_RESUME: tasks,
+     *    RAM and the LoRa module are kept) or resets the board.
      * 
      * @param secondsDuration Number of seconds to sleep.
      */
     static void deepSleep(int secondsDuration);
 
+    // millis() plus the time spent in standby (millis() stops while asleep).
+    // For windows that must span sleep cycles, e.g. the duty-cycle hour.
+    static uint32_t uptimeMs();
+
 private:
     // Callback for the RTC Interrupt
     static void alarmCallback();
 
     // Low-level register manipulation to enter Standby Mode
     static void enterStandbyMode(uint32_t sleepDurationS);
+
+    // Warm resume: catches the FreeRTOS tick count and uptimeMs() up with the sleep
+    static void resume(uint32_t asleepAt);
 };
 
 #endif // SLEEP_MANAGER_H
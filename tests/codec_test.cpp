@@ -0,0 +1,192 @@
+// Host tests of the LoRa wire codecs (lib/R4Telemetry/src): BATCH readings,
+// MEASURE TLV records, Wio-E5 receive URCs and the hex codec.
+//
+//   just test
+//
+// Round trips plus the inputs each decoder must reject. Exits 1 on a failure.
+
+#include <stdio.h>
+#include <string.h>
+#include "../lib/R4Telemetry/src/lora_batch.h"
+#include "../lib/R4Telemetry/src/lora_tlv.h"
+#include "../lib/R4Telemetry/src/lora_rx_parser.h"
+#include "../lib/R4Telemetry/src/hex_codec.h"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                   \
+    do {                                                              \
+        if (!(cond)) {                                                \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);    \
+            failures++;                                               \
+        }                                                             \
+    } while (0)
+
+static void testHex() {
+    const uint8_t data[] = { 0x00, 0x7f, 0xa5, 0xff };
+    char hex[2 * sizeof(data) + 1];
+    CHECK(hex_encode_cstr(data, sizeof(data), hex) == 2 * sizeof(data));
+    CHECK(strcmp(hex, "007fa5ff") == 0);
+
+    uint8_t out[4];
+    CHECK(hex_decode("007FA5ff", 8, out, sizeof(out)) == 4);
+    CHECK(memcmp(out, data, sizeof(data)) == 0);
+    CHECK(hex_decode("", 0, out, sizeof(out)) == 0);
+    CHECK(hex_decode("abc", 3, out, sizeof(out)) == -1);       // Odd length
+    CHECK(hex_decode("0g", 2, out, sizeof(out)) == -1);        // Not hex
+    CHECK(hex_decode("0011223344", 10, out, sizeof(out)) == -1); // Does not fit
+}
+
+static void testBatchRoundTrip() {
+    LoraReading in[13];
+    for (int i = 0; i < 13; i++) {
+        in[i].time = 1760000000UL + 15 * i;
+        in[i].temperature = (int16_t)(2150 + (i % 3) - 1);
+        in[i].humidity = (int16_t)(4800 - i);
+    }
+    in[5].temperature = 0x7FFF;   // Sensor error: large jump out and back
+    in[6].humidity = -32768;
+
+    uint8_t buf[64];
+    size_t encoded;
+    size_t len = lora_batch_encode(in, 13, buf, sizeof(buf), &encoded);
+    CHECK(encoded == 13);
+    CHECK(len > LORA_BATCH_HEADER_LEN && len <= sizeof(buf));
+
+    LoraReading out[LORA_BATCH_MAX_READINGS];
+    CHECK(lora_batch_decode(buf, len, out, LORA_BATCH_MAX_READINGS) == 13);
+    for (int i = 0; i < 13; i++) {
+        CHECK(out[i].time == in[i].time);
+        CHECK(out[i].temperature == in[i].temperature);
+        CHECK(out[i].humidity == in[i].humidity);
+    }
+
+    // Too few slots, truncated, trailing byte
+    CHECK(lora_batch_decode(buf, len, out, 12) == -1);
+    CHECK(lora_batch_decode(buf, len - 1, out, LORA_BATCH_MAX_READINGS) == -1);
+    buf[len] = 0;
+    CHECK(lora_batch_decode(buf, len + 1, out, LORA_BATCH_MAX_READINGS) == -1);
+
+    // Encoder stops at the capacity, and before a reading that goes back in time
+    len = lora_batch_encode(in, 13, buf, 20, &encoded);
+    CHECK(encoded > 1 && encoded < 13 && len <= 20);
+    CHECK(lora_batch_decode(buf, len, out, LORA_BATCH_MAX_READINGS) == (int)encoded);
+    in[4].time = in[3].time - 1;
+    lora_batch_encode(in, 13, buf, sizeof(buf), &encoded);
+    CHECK(encoded == 4);
+    CHECK(lora_batch_encode(in, 13, buf, LORA_BATCH_HEADER_LEN - 1, &encoded) == 0 && encoded == 0);
+}
+
+static void testBatchRejects() {
+    // [COUNT=2, TIME0, T0=32700, H0=0] dt=1, dT=zz(+100)=200, dH=0
+    uint8_t overflow[] = { 2, 0, 0, 0, 0, 0xBC, 0x7F, 0, 0, 1, 0xC8, 0x01, 0 };
+    LoraReading out[LORA_BATCH_MAX_READINGS];
+    CHECK(lora_batch_decode(overflow, sizeof(overflow), out, LORA_BATCH_MAX_READINGS) == -1);
+    uint8_t fits[] = { 2, 0, 0, 0, 0, 0xBC, 0x7F, 0, 0, 1, 0x02, 0 };   // dT = +1
+    CHECK(lora_batch_decode(fits, sizeof(fits), out, LORA_BATCH_MAX_READINGS) == 2);
+    CHECK(out[1].temperature == 32701);
+
+    // Time wrapping past 2^32
+    uint8_t wrap[] = { 2, 0xFF, 0xFF, 0xFF, 0xFF, 0, 0, 0, 0, 1, 0, 0 };
+    CHECK(lora_batch_decode(wrap, sizeof(wrap), out, LORA_BATCH_MAX_READINGS) == -1);
+
+    // Varint longer than 5 bytes, zero count, short header
+    uint8_t longVarint[] = { 2, 0, 0, 0, 0, 0, 0, 0, 0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01, 0, 0 };
+    CHECK(lora_batch_decode(longVarint, sizeof(longVarint), out, LORA_BATCH_MAX_READINGS) == -1);
+    uint8_t zero[LORA_BATCH_HEADER_LEN] = { 0 };
+    CHECK(lora_batch_decode(zero, sizeof(zero), out, LORA_BATCH_MAX_READINGS) == -1);
+    CHECK(lora_batch_decode(overflow, LORA_BATCH_HEADER_LEN - 1, out, LORA_BATCH_MAX_READINGS) == -1);
+}
+
+static void testTlv() {
+    uint8_t buf[16];
+    LoraTlvWriter w;
+    lora_tlv_init(&w, buf, sizeof(buf));
+    CHECK(lora_tlv_put_u16(&w, LORA_TLV_TEMPERATURE, (uint16_t)-512));
+    CHECK(lora_tlv_put_u32(&w, LORA_TLV_TIME, 1760000000UL));
+    CHECK(lora_tlv_put_u16(&w, 0x7E, 0xBEEF));   // Unknown type, skipped by readers
+    CHECK(w.len == 14 && !w.overflow);
+    CHECK(!lora_tlv_put_u16(&w, LORA_TLV_HUMIDITY, 1));   // 14 + 4 > 16
+    CHECK(w.overflow && w.len == 14);
+
+    size_t offset = 0;
+    LoraTlvRecord r;
+    CHECK(lora_tlv_next(buf, w.len, &offset, &r) && r.type == LORA_TLV_TEMPERATURE);
+    CHECK((int16_t)lora_tlv_u16(r) == -512);
+    CHECK(lora_tlv_u32(r) == 0);   // Length mismatch
+    CHECK(lora_tlv_next(buf, w.len, &offset, &r) && r.type == LORA_TLV_TIME);
+    CHECK(lora_tlv_u32(r) == 1760000000UL);
+    CHECK(lora_tlv_next(buf, w.len, &offset, &r) && r.type == 0x7E && r.len == 2);
+    CHECK(!lora_tlv_next(buf, w.len, &offset, &r) && offset == w.len);
+    CHECK(lora_tlv_valid(buf, w.len));
+    CHECK(lora_tlv_valid(buf, 0));
+
+    // Truncated: inside a value, inside a header
+    for (size_t cut = 1; cut < w.len; cut++) {
+        bool boundary = (cut == 4 || cut == 10);
+        CHECK(lora_tlv_valid(buf, cut) == boundary);
+    }
+    offset = 0;
+    CHECK(lora_tlv_next(buf, 3, &offset, &r) == false && offset == 0);
+    uint8_t oversized[] = { LORA_TLV_BATTERY, 0xFF, 0x01 };
+    CHECK(!lora_tlv_valid(oversized, sizeof(oversized)));
+}
+
+static LoraRxLineType parse(const char *line, LoraRxMeta *meta, uint8_t *frame, size_t cap, size_t *frameLen) {
+    return lora_parse_rx_line(line, strlen(line), meta, frame, cap, frameLen);
+}
+
+static void testRxParser() {
+    LoraRxMeta meta = { 0, 0, 0 };
+    uint8_t frame[8];
+    size_t frameLen = 0;
+
+    CHECK(parse("+TEST: LEN:7, RSSI:-42, SNR:11", &meta, frame, sizeof(frame), &frameLen) == RX_LINE_META);
+    CHECK(meta.len == 7 && meta.rssi == -42 && meta.snr == 11);
+    CHECK(parse("+TEST: LEN:12, RSSI:-118, SNR:-15", &meta, frame, sizeof(frame), &frameLen) == RX_LINE_META);
+    CHECK(meta.rssi == -118 && meta.snr == -15);
+
+    CHECK(parse("+TEST: RX \"0102A0ff\"", &meta, frame, sizeof(frame), &frameLen) == RX_LINE_FRAME);
+    CHECK(frameLen == 4 && frame[0] == 0x01 && frame[2] == 0xA0 && frame[3] == 0xFF);
+
+    // Rejected lines leave *meta and *frameLen alone
+    const char *malformed[] = {
+        "+TEST: RX \"\"",                       // Empty hex
+        "+TEST: RX \"012\"",                    // Odd hex
+        "+TEST: RX \"01zz\"",                   // Not hex
+        "+TEST: RX \"0102",                     // No closing quote
+        "+TEST: RX \"000102030405060708\"",     // Longer than the frame buffer
+        "+TEST: LEN:123456, RSSI:-42, SNR:11",  // Over-long number
+        "+TEST: LEN:7, RSSI:-999999, SNR:11",
+        "+TEST: LEN:7, RSSI:, SNR:11",
+        "+TEST: LEN:7, RSSI:-42, SNR:11 ",      // Trailing character
+        "+TEST: LEN:7, RSSI:-42",
+    };
+    for (size_t i = 0; i < sizeof(malformed) / sizeof(malformed[0]); i++) {
+        if (parse(malformed[i], &meta, frame, sizeof(frame), &frameLen) != RX_LINE_MALFORMED) {
+            printf("FAIL: not rejected: %s\n", malformed[i]);
+            failures++;
+        }
+    }
+    CHECK(meta.len == 12 && meta.rssi == -118 && meta.snr == -15);
+    CHECK(frameLen == 4);
+
+    CHECK(parse("+TEST: TX DONE", &meta, frame, sizeof(frame), &frameLen) == RX_LINE_OTHER);
+    CHECK(parse("OK", &meta, frame, sizeof(frame), &frameLen) == RX_LINE_OTHER);
+    CHECK(parse("", &meta, frame, sizeof(frame), &frameLen) == RX_LINE_OTHER);
+}
+
+int main() {
+    testHex();
+    testBatchRoundTrip();
+    testBatchRejects();
+    testTlv();
+    testRxParser();
+
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("Codec tests: OK\n");
+    return 0;
+}
@@ -0,0 +1,115 @@
+// Host benchmark of the LoRa MAC engines (lib/R4Telemetry/src/security_utils.cpp).
+//
+//   just bench-mac
+//
+// Reports the cost of authenticating a frame with HMAC-SHA256 (protocol v0/v1,
+// with and without cached key midstates) and SipHash-2-4 (protocol v2).
+// Code size of each engine is printed by the recipe with `size`. SipHash-2-4 is
+// first checked against the reference test vectors (key 00..0f, message 00..n-1).
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include "../lib/R4Telemetry/src/security_utils.h"
+#include "../lib/R4Telemetry/src/siphash.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static uint64_t now_ticks() { return __rdtsc(); }
+static const char *TICK_UNIT = "cycles";
+#else
+static uint64_t now_ticks() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+static const char *TICK_UNIT = "ns";
+#endif
+
+static const char SECRET[] = "IoT_Secure_P@ssw0rd_2026";
+static volatile uint8_t sink;
+
+template <typename Fn>
+static double ticksPerCall(Fn macOnce) {
+    const int ITER = 20000;
+    uint64_t best = ~0ull;
+    for (int run = 0; run < 5; run++) {
+        uint64_t t0 = now_ticks();
+        for (int i = 0; i < ITER; i++) macOnce();
+        uint64_t dt = now_ticks() - t0;
+        if (dt < best) best = dt;
+    }
+    return (double)best / ITER;
+}
+
+// Reference implementation vectors (vectors.h), output bytes in order
+struct SipHashVector {
+    size_t len;
+    uint8_t out[SIPHASH_OUTPUT_LEN];
+};
+static const SipHashVector SIPHASH_VECTORS[] = {
+    { 0,  { 0x31, 0x0e, 0x0e, 0xdd, 0x47, 0xdb, 0x6f, 0x72 } },
+    { 15, { 0xe5, 0x45, 0xbe, 0x49, 0x61, 0xca, 0x29, 0xa1 } },
+    { 63, { 0x72, 0x45, 0x06, 0xeb, 0x4c, 0x32, 0x8a, 0x95 } },
+};
+
+// One-shot and byte-by-byte updates must both give the reference output
+static bool checkSipHashVectors() {
+    uint8_t key[SIPHASH_KEY_LEN], msg[64], out[SIPHASH_OUTPUT_LEN];
+    for (size_t i = 0; i < sizeof(key); i++) key[i] = (uint8_t)i;
+    for (size_t i = 0; i < sizeof(msg); i++) msg[i] = (uint8_t)i;
+
+    for (const SipHashVector &v : SIPHASH_VECTORS) {
+        for (int split = 0; split < 2; split++) {
+            SipHashContext ctx;
+            siphash_init(&ctx, key);
+            if (split) {
+                for (size_t i = 0; i < v.len; i++) siphash_update(&ctx, msg + i, 1);
+            } else {
+                siphash_update(&ctx, msg, v.len);
+            }
+            siphash_final(&ctx, out);
+            if (memcmp(out, v.out, sizeof(out)) != 0) {
+                printf("SipHash-2-4 MISMATCH: len %zu (%s)\n", v.len, split ? "byte by byte" : "one shot");
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main() {
+    if (!checkSipHashVectors()) return 1;
+    printf("SipHash-2-4 vs reference vectors: OK\n\n");
+
+    MacKey key;
+    mac_key_init(&key, (const uint8_t*)SECRET, strlen(SECRET));
+
+    static uint8_t msg[64];
+    for (size_t i = 0; i < sizeof(msg); i++) msg[i] = (uint8_t)i;
+
+    // Sanity: the engine dispatch must match the direct HMAC
+    uint8_t a[32], b[32];
+    hmac_sha256((const uint8_t*)SECRET, strlen(SECRET), msg, 8, a);
+    mac_compute(MAC_HMAC_SHA256, &key, msg, 8, b);
+    if (memcmp(a, b, 32) != 0) { printf("HMAC engine mismatch\n"); return 1; }
+
+    printf("%-6s %16s %16s %16s\n", "bytes", "hmac (secret)", "hmac (cached)", "siphash-2-4");
+    const size_t sizes[] = { 8, 16, 64 }; // v1/v2 data frame header+body, ACK + tag, long frame
+    for (size_t len : sizes) {
+        double hmacSecret = ticksPerCall([&] {
+            uint8_t out[32];
+            hmac_sha256((const uint8_t*)SECRET, strlen(SECRET), msg, len, out); sink = out[0];
+        });
+        double hmacCached = ticksPerCall([&] {
+            uint8_t out[32];
+            mac_compute(MAC_HMAC_SHA256, &key, msg, len, out); sink = out[0];
+        });
+        double sip = ticksPerCall([&] {
+            uint8_t out[32];
+            mac_compute(MAC_SIPHASH_2_4, &key, msg, len, out); sink = out[0];
+        });
+        printf("%-6zu %9.0f %-6s %9.0f %-6s %9.0f %-6s\n", len,
+               hmacSecret, TICK_UNIT, hmacCached, TICK_UNIT, sip, TICK_UNIT);
+    }
+    return 0;
+}
@@ -0,0 +1,157 @@
+// Host benchmark for the firmware SHA-256 core (lib/R4Telemetry/src/sha256.cpp).
+//
+//   g++ -O2 -o tests/sha256_bench tests/sha256_bench.cpp lib/R4Telemetry/src/sha256.cpp
+//   ./tests/sha256_bench
+//
+// 1. Checks bit-exact output against the previous byte-by-byte implementation
+//    (random lengths and random update splits).
+// 2. Reports cycles/byte for 7, 64 and 512-byte messages (TSC on x86, ns otherwise).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "../lib/R4Telemetry/src/sha256.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static uint64_t now_ticks() { return __rdtsc(); }
+static const char *TICK_UNIT = "cycles";
+#else
+static uint64_t now_ticks() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+static const char *TICK_UNIT = "ns";
+#endif
+
+// --- Reference: SHA-256 core as shipped before the rewrite ---
+namespace ref {
+
+#define ROTRIGHT(a,b) (((a) >> (b)) | ((a) << (32-(b))))
+#define SIG0(x) (ROTRIGHT(x,7) ^ ROTRIGHT(x,18) ^ ((x) >> 3))
+#define SIG1(x) (ROTRIGHT(x,17) ^ ROTRIGHT(x,19) ^ ((x) >> 10))
+#define CH(x,y,z) (((x) & (y)) ^ (~(x) & (z)))
+#define MAJ(x,y,z) (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+#define EP0(x) (ROTRIGHT(x,2) ^ ROTRIGHT(x,13) ^ ROTRIGHT(x,22))
+#define EP1(x) (ROTRIGHT(x,6) ^ ROTRIGHT(x,11) ^ ROTRIGHT(x,25))
+
+static const uint32_t k[64] = {
+    0x428a2f98,0x71374491,0xb5c0fbcf,0xe9b5dba5,0x3956c25b,0x59f111f1,0x923f82a4,0xab1c5ed5,
+    0xd807aa98,0x12835b01,0x243185be,0x550c7dc3,0x72be5d74,0x80deb1fe,0x9bdc06a7,0xc19bf174,
+    0xe49b69c1,0xefbe4786,0x0fc19dc6,0x240ca1cc,0x2de92c6f,0x4a7484aa,0x5cb0a9dc,0x76f988da,
+    0x983e5152,0xa831c66d,0xb00327c8,0xbf597fc7,0xc6e00bf3,0xd5a79147,0x06ca6351,0x14292967,
+    0x27b70a85,0x2e1b2138,0x4d2c6dfc,0x53380d13,0x650a7354,0x766a0abb,0x81c2c92e,0x92722c85,
+    0xa2bfe8a1,0xa81a664b,0xc24b8b70,0xc76c51a3,0xd192e819,0xd6990624,0xf40e3585,0x106aa070,
+    0x19a4c116,0x1e376c08,0x2748774c,0x34b0bcb5,0x391c0cb3,0x4ed8aa4a,0x5b9cca4f,0x682e6ff3,
+    0x748f82ee,0x78a5636f,0x84c87814,0x8cc70208,0x90befffa,0xa4506ceb,0xbef9a3f7,0xc67178f2
+};
+
+static void transform(SHA256_CTX *ctx, const uint8_t data[]) {
+    uint32_t a, b, c, d, e, f, g, h, i, j, t1, t2, m[64];
+    for (i = 0, j = 0; i < 16; ++i, j += 4)
+        m[i] = (data[j] << 24) | (data[j + 1] << 16) | (data[j + 2] << 8) | (data[j + 3]);
+    for (; i < 64; ++i)
+        m[i] = SIG1(m[i - 2]) + m[i - 7] + SIG0(m[i - 15]) + m[i - 16];
+    a = ctx->state[0]; b = ctx->state[1]; c = ctx->state[2]; d = ctx->state[3];
+    e = ctx->state[4]; f = ctx->state[5]; g = ctx->state[6]; h = ctx->state[7];
+    for (i = 0; i < 64; ++i) {
+        t1 = h + EP1(e) + CH(e, f, g) + k[i] + m[i];
+        t2 = EP0(a) + MAJ(a, b, c);
+        h = g; g = f; f = e; e = d + t1; d = c; c = b; b = a; a = t1 + t2;
+    }
+    ctx->state[0] += a; ctx->state[1] += b; ctx->state[2] += c; ctx->state[3] += d;
+    ctx->state[4] += e; ctx->state[5] += f; ctx->state[6] += g; ctx->state[7] += h;
+}
+
+static void update(SHA256_CTX *ctx, const uint8_t data[], size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        ctx->data[ctx->datalen++] = data[i];
+        if (ctx->datalen == 64) {
+            transform(ctx, ctx->data);
+            ctx->bitlen += 512;
+            ctx->datalen = 0;
+        }
+    }
+}
+
+static void final(SHA256_CTX *ctx, uint8_t hash[]) {
+    uint32_t i = ctx->datalen;
+    if (ctx->datalen < 56) {
+        ctx->data[i++] = 0x80;
+        while (i < 56) ctx->data[i++] = 0x00;
+    } else {
+        ctx->data[i++] = 0x80;
+        while (i < 64) ctx->data[i++] = 0x00;
+        transform(ctx, ctx->data);
+        memset(ctx->data, 0, 56);
+    }
+    ctx->bitlen += ctx->datalen * 8;
+    for (int n = 0; n < 8; n++) ctx->data[63 - n] = (uint8_t)(ctx->bitlen >> (n * 8));
+    transform(ctx, ctx->data);
+    for (i = 0; i < 32; ++i) hash[i] = (ctx->state[i / 4] >> (24 - (i % 4) * 8)) & 0xff;
+}
+
+} // namespace ref
+
+static bool checkBitExact() {
+    static uint8_t msg[1024];
+    for (size_t i = 0; i < sizeof(msg); i++) msg[i] = (uint8_t)rand();
+
+    for (int iter = 0; iter < 2000; iter++) {
+        size_t len = rand() % sizeof(msg);
+        size_t split = len ? rand() % (len + 1) : 0;
+        uint8_t expected[32], actual[32];
+
+        SHA256_CTX r; sha256_init(&r);
+        ref::update(&r, msg, len); ref::final(&r, expected);
+
+        SHA256_CTX c; sha256_init(&c);
+        sha256_update(&c, msg, split); sha256_update(&c, msg + split, len - split);
+        sha256_final(&c, actual);
+
+        if (memcmp(expected, actual, 32) != 0) {
+            printf("MISMATCH len=%zu split=%zu\n", len, split);
+            return false;
+        }
+    }
+    return true;
+}
+
+static volatile uint8_t sink;
+
+template <typename Fn>
+static double ticksPerByte(size_t len, Fn hashOnce) {
+    const int ITER = 20000;
+    uint64_t best = ~0ull;
+    for (int run = 0; run < 5; run++) {
+        uint64_t t0 = now_ticks();
+        for (int i = 0; i < ITER; i++) hashOnce();
+        uint64_t dt = now_ticks() - t0;
+        if (dt < best) best = dt;
+    }
+    return (double)best / ITER / len;
+}
+
+int main() {
+    if (!checkBitExact()) return 1;
+    printf("Bit-exact vs reference: OK\n\n");
+
+    static uint8_t msg[512];
+    for (size_t i = 0; i < sizeof(msg); i++) msg[i] = (uint8_t)i;
+
+    printf("%-6s %14s %14s\n", "bytes", "reference", "optimized");
+    const size_t sizes[] = { 7, 64, 512 };
+    for (size_t len : sizes) {
+        double before = ticksPerByte(len, [&] {
+            SHA256_CTX c; uint8_t out[32];
+            sha256_init(&c); ref::update(&c, msg, len); ref::final(&c, out); sink = out[0];
+        });
+        double after = ticksPerByte(len, [&] {
+            SHA256_CTX c; uint8_t out[32];
+            sha256_init(&c); sha256_update(&c, msg, len); sha256_final(&c, out); sink = out[0];
+        });
+        printf("%-6zu %9.1f %s/B %9.1f %s/B\n", len, before, TICK_UNIT, after, TICK_UNIT);
+    }
+    return 0;
+}